@@ -8,6 +8,7 @@ int main( ){
 	ofGLWindowSettings settings;
 	settings.setSize(1024, 768);
 	settings.windowMode = OF_WINDOW; //Okno w trybie okienkowym - może być zmienione na OF_FULLSCREEN
+	settings.setGLVersion(3, 2);	//Programowalny renderer - potrzebny do instancyjnego rysowania cząstek
 
 	auto window = ofCreateWindow(settings);		//Tworzy okno z podanymi ustawieniami
 
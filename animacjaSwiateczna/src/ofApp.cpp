@@ -5,25 +5,52 @@ void ofApp::setup() {
     ofSetFrameRate(60);
     ofBackground(0);
     ofEnableDepthTest(); // Włącza test głębi   - żeby cząstecki za kulą sie chowały a przed były widoczne
-//                          pozycja    , zakres emisji,         predkosc               kolor             czas zycia    ilosc na sek, masa
-    EmitterSnow emitter(ofVec3f(0, 500, 0),    // Pozycja
-                    ofVec3f(1000, 0, 1000),  // Zakres emisji
-                    ofVec3f(1, 1, 1),    // Zakres prędkości
-                    ofColor(255, 255, 255), // Kolor
-                    5.0f,                 // Czas życia
-                    400,                  // Szybkość emisji
-                    1.0f);                // Masa cząstki
-    particleSystem = new ParticleSystem(emitter);
+    if (!sceneFile.open(ofToDataPath("scene.json", true))) {     // Parametry sceny - bez pliku zostają domyślne z Scenes.h
+        ofLogWarning("ofApp") << "scene.json: " << sceneFile.error() << " - domyslne parametry";
+    }
+    createSystem(0);                            // Aktualizacja na wszystkich rdzeniach
+    world = nullptr;
+    worldScheduler = nullptr;
+    replayTime = 0;
+    lastRecordedStep = 0;
 
     backgroundImage.load("background.jpg"); // Załaduj obrazek
 }
 
 //--------------------------------------------------------------
 void ofApp::update(){                            //Aktualizuje logikę aplikacji
-    float dt = ofGetLastFrameTime();            //Oblicza czas między klatkami (dt w sekundach)
-    ofVec3f wind(1, -2, 0);                      //Wprowadza siłę wiatru (5 jednostek w prawo)
-    particleSystem->applyForce(wind);           //Dodaje siłę do każdej cząstki
-    particleSystem->update(dt);                 //Aktualizuje położenie i stan cząstek
+    if (sceneFile.poll()) {                     //Plik sceny zmieniony - nowe parametry dla działającego systemu
+        scheduler->modify([this](ParticleSystem<EmitterSet>& system) {
+            SceneConfig::apply(system, sceneFile.get());
+        });
+        wind = SceneConfig::wind(sceneFile.get(), Scenes::snowWind());
+        ofLogNotice("ofApp") << "Wczytano scene.json";
+    }
+    scheduler->setForce(wind);                  //Wprowadza siłę wiatru - kroki symulacji (stałe dt) liczy wątek schedulera
+    if (world) {                                //Kawałki wokół kamery są aktywne
+        world->setFocus(cam.getPosition());
+        worldScheduler->setForce(wind);
+    }
+}
+
+//--------------------------------------------------------------
+void ofApp::createSystem(unsigned threads){     //Nowy system i scheduler: śnieg, dym i iskry z Scenes.h nadpisane plikiem sceny
+    particleSystem = new ParticleSystem<EmitterSet>(Scenes::christmasEmitters());
+    Scenes::setupChristmas(*particleSystem);
+    SceneConfig::apply(*particleSystem, sceneFile.get(), true);
+    wind = SceneConfig::wind(sceneFile.get(), Scenes::snowWind());
+    particleSystem->setThreadCount(threads);
+    scheduler = new FixedStepScheduler<ParticleSystem<EmitterSet>>(*particleSystem, Scenes::stepRate, Scenes::maxStepsPerFrame);
+    scheduler->start();                         // Od teraz system zmieniamy tylko przez scheduler->modify
+}
+
+//--------------------------------------------------------------
+void ofApp::exit(){
+    recorder.close();
+    delete worldScheduler;
+    delete world;
+    delete scheduler;                           //Zatrzymuje wątek symulacji przed usunięciem systemu
+    delete particleSystem;
 }
 
 //--------------------------------------------------------------
@@ -34,25 +61,193 @@ void ofApp::draw(){                             //Rysuje scenę
     cam.begin();                               //Aktywuje kamerę 3D
     ofEnableDepthTest();  
     //ofDrawAxis(200);                            //Ośie układu współrzędnych
-    particleSystem->draw();                     //Rysuje wszystkie cząstki
+    drawParticles();                            //Symulacja albo odtwarzane nagranie
 
     cam.end();
+
+    drawStats();
+}
+
+//--------------------------------------------------------------
+void ofApp::drawParticles(){                    //Rysuje cząstki z symulacji (i nagrywa nowe stany) albo z nagrania
+    if (world) {                                //Świat z kawałków zamiast sceny
+        worldScheduler->draw();
+        return;
+    }
+    if (replay.isOpen()) {
+        replayTime += ofGetLastFrameTime();
+        if (replayTime > replay.frameTime(replay.frameCount() - 1)) {
+            replayTime = replay.frameTime(0);   //Nagranie odtwarzane w pętli
+        }
+        replay.readFrame(replay.frameAt(replayTime), replayPool);
+        particleSystem->draw(replayPool, 0);    //Bez symulacji - tylko rysowanie nagranego stanu
+        return;
+    }
+    scheduler->draw();                          //Rysuje wszystkie cząstki (interpolacja między krokami)
+    if (recorder.isOpen() && scheduler->renderedStep() != lastRecordedStep) {     //Nagrywany jest każdy nowy stan z symulacji
+        lastRecordedStep = scheduler->renderedStep();
+        recorder.addFrame(scheduler->renderedState(), lastRecordedStep * double(scheduler->getStepDt()));
+    }
+}
+
+//--------------------------------------------------------------
+void ofApp::toggleRecording(){                  //Włącza/wyłącza nagrywanie do bin/data/recording.prec
+    if (recorder.isOpen()) {
+        ofLogNotice("ofApp") << "Nagrano " << recorder.frameCount() << " klatek, " << recorder.bytesWritten() / 1024 << " KB";
+        recorder.close();
+        return;
+    }
+    ofDirectory::createDirectory(ofToDataPath("", true), false, true);
+    if (!recorder.open(ofToDataPath("recording.prec", true))) {
+        ofLogError("ofApp") << "Nie mozna zapisac recording.prec";
+    }
+}
+
+//--------------------------------------------------------------
+void ofApp::toggleReplay(){                     //Przełącza między symulacją a odtwarzaniem bin/data/recording.prec
+    if (replay.isOpen()) {
+        replay.close();
+        scheduler->start();                     //Symulacja rusza od stanu sprzed odtwarzania
+        return;
+    }
+    recorder.close();                           //Nagrywany plik musi być kompletny przed odczytem
+    if (!replay.open(ofToDataPath("recording.prec", true)) || replay.frameCount() == 0) {
+        ofLogError("ofApp") << "Brak nagrania recording.prec (c - nagrywanie)";
+        replay.close();
+        return;
+    }
+    scheduler->stop();                          //Przy odtwarzaniu symulacja nie jest liczona
+    replayTime = replay.frameTime(0);
+}
+
+//--------------------------------------------------------------
+void ofApp::toggleWorld(){                      //Przełącza między sceną a śniegiem na świecie z kawałków (strony w bin/data/chunks)
+    if (world) {
+        delete worldScheduler;                  //Zatrzymuje wątek symulacji świata i usuwa strony z dysku
+        delete world;
+        worldScheduler = nullptr;
+        world = nullptr;
+        scheduler->start();                     //Scena rusza od stanu sprzed włączenia świata
+        return;
+    }
+    recorder.close();
+    if (replay.isOpen()) {
+        replay.close();
+    }
+    scheduler->stop();                          //Scena nie jest liczona, gdy widać świat
+    ChunkSettings settings;
+    settings.pageDirectory = ofToDataPath("chunks", true);
+    world = new ChunkedWorld<EmitterSnow>(settings, Scenes::snowChunkEmitter, Scenes::setupSnow);
+    world->particleRadius = 1.0f;
+    world->renderer.mode = particleSystem->renderer.mode;
+    world->setThreadCount(0);                   //Kawałki liczone równolegle
+    world->setFocus(cam.getPosition());
+    worldScheduler = new FixedStepScheduler<ChunkedWorld<EmitterSnow>>(*world, Scenes::stepRate, Scenes::maxStepsPerFrame);
+    worldScheduler->setForce(wind);
+    worldScheduler->start();
+}
+
+//--------------------------------------------------------------
+void ofApp::drawStats(){                        //Tryb rysowania, liczba cząstek i czas klatki - do porównania trybów
+    ofDisableDepthTest();
+    const ParticleRenderer& renderer = world ? world->renderer : particleSystem->renderer;
+    const size_t live = world ? worldScheduler->renderedCount() : replay.isOpen() ? replayPool.size() : scheduler->renderedCount();
+    std::string stats = "Tryb: " + std::string(ParticleRenderer::modeName(renderer.mode)) + " (m - zmiana)\n"
+                      + "Czastki: " + ofToString(live) + "\n"
+                      + "Watki: " + ofToString(particleSystem->threadCount()) + " (t - zmiana)\n"
+                      + "Pula: " + ParticlePool::layoutName(particleSystem->particles.layout()) + ", "
+                      + ofToString(ParticlePool::bytesPerParticle(particleSystem->particles.layout())) + " B na czastke (k - zmiana)\n"
+                      + "Oddzialywania: " + ParticleInteractions::modeName(particleSystem->interactions.mode) + " (i - zmiana)\n"
+                      + "Krok: " + ofToString(int(Scenes::stepRate)) + " Hz, pominiete: " + ofToString(scheduler->getDroppedSteps()) + "\n"
+                      + "Klatka: " + ofToString(ofGetLastFrameTime() * 1000.0, 2) + " ms (" + ofToString(ofGetFrameRate(), 1) + " fps)";
+    if (!world && particleSystem->ground.enabled()) {      //Śnieg na ziemi: płatki zamienione na warstwę i wiersze siatki wysłane w tej klatce
+        const GroundAccumulation& ground = particleSystem->ground;
+        stats += "\nZiemia: " + ofToString(ground.depositedCount()) + " platkow, grubosc do " + ofToString(ground.maxSnowDepth(), 1)
+               + ", wiersze " + ofToString(ground.lastUploadedRows()) + "/" + ofToString(ground.getResolution());
+    }
+    if (recorder.isOpen()) {
+        stats += "\nNagrywanie: " + ofToString(recorder.frameCount()) + " klatek, " + ofToString(recorder.bytesWritten() / 1024) + " KB (c - stop)";
+    }
+    stats += "\nScena: " + (sceneFile.error().empty() ? "scene.json, wczytana " + ofToString(sceneFile.loadCount()) + " raz(y)"
+                                                    : "blad - " + sceneFile.error());
+    if (replay.isOpen()) {
+        stats += "\nOdtwarzanie: klatka " + ofToString(replay.frameAt(replayTime) + 1) + "/" + ofToString(replay.frameCount()) + " (p - powrot do symulacji)";
+    }
+    if (world) {                                //Kawałki świata wg stanu, strony na dysku i koszt kroku
+        ChunkMetrics m = world->metrics();
+        stats += "\nSwiat: aktywne " + ofToString(m.active) + ", statystyczne " + ofToString(m.statistical) + ", zamrozone " + ofToString(m.frozen)
+               + ", na dysku " + ofToString(m.paged) + " (" + ofToString(m.pagedBytes / 1024) + " KB), odwiedzone " + ofToString(m.created)
+               + "\nKrok swiata: " + ofToString(m.updateMs, 2) + " ms, czastki aktywne " + ofToString(m.activeParticles)
+               + " / w pamieci " + ofToString(m.residentParticles) + " (w - powrot do sceny)";
+    }
+    if (renderer.mode == RenderMode::Lod) {     //Koszyki LOD z ostatniej klatki
+        const LodBuckets& lod = renderer.lodBuckets();
+        stats += "\nLOD: kule " + ofToString(lod.meshes.size()) + ", punkty " + ofToString(lod.sprites.size())
+               + ", sub-piksel " + ofToString(lod.subPixel) + " w " + ofToString(lod.aggregates.size()) + " kafelkach"
+               + ", poza kadrem " + ofToString(lod.culled);
+    }
+    ofDrawBitmapStringHighlight(stats, 10, 20);
+    FrameProfiler& profiler = FrameProfiler::global();
+    if (profiler.enabled()) {                   //Nakładka profilera: p50/p99 etapów z ostatnich 2 s
+        profiler.collect();
+        ofDrawBitmapStringHighlight(profiler.report(live) + "\n(f - ukryj, e - zapis trace.json)", ofGetWidth() - 300, 20);
+    }
+    ofEnableDepthTest();
 }
 
 //--------------------------------------------------------------
 void ofApp::keyPressed(int key){                //Obsługuje naciśnięcia klawiszy
-    /*if (key == 'r') {                           //Klawisz 'r' resetuje system cząsteczek
-        delete particleSystem;                  //Usuwa istniejący system 
-        EmitterSnow emitter(ofVec3f(0, 0, 0),    // Pozycja
-                    ofVec3f(1000, 0, 0),  // Zakres emisji
-                    ofVec3f(10, 5, 5),    // Zakres prędkości
-                    ofColor(255, 255, 255), // Kolor
-                    7.0f,                 // Czas życia
-                    100,                  // Szybkość emisji
-                    1.0f);                // Masa cząstki
-        particleSystem = new ParticleSystem(emitter);
-    }
-    */
+    if (key == 'w') {                           //Klawisz 'w' przełącza scenę / śnieg na świecie z kawałków
+        toggleWorld();
+        return;
+    }
+    if (world && key != 'm' && key != 'f' && key != 'e') {     //Przy świecie klawisze sceny (reset, nagrywanie, pula...) nie działają
+        return;
+    }
+    if (key == 'r') {                           //Klawisz 'r' resetuje system cząsteczek (parametry z pliku sceny)
+        RenderMode mode = particleSystem->renderer.mode;
+        unsigned threads = particleSystem->threadCount();
+        recorder.close();                       //Nagranie obejmuje jeden przebieg symulacji
+        lastRecordedStep = 0;
+        replay.close();                         //Reset kończy odtwarzanie - widać nową symulację, a nie nagranie
+        delete scheduler;                       //Najpierw zatrzymuje wątek symulacji
+        delete particleSystem;                  //Usuwa istniejący system
+        createSystem(threads);
+        particleSystem->renderer.mode = mode;   //Tryb rysowania i liczba wątków przetrwają reset
+    }
+    if (key == 'c') {                           //Klawisz 'c' włącza/wyłącza nagrywanie symulacji
+        toggleRecording();
+    }
+    if (key == 'p') {                           //Klawisz 'p' odtwarza nagranie (bez symulacji)
+        toggleReplay();
+    }
+    if (key == 'f') {                           //Klawisz 'f' włącza/wyłącza profiler i jego nakładkę
+        FrameProfiler::global().setEnabled(!FrameProfiler::global().enabled());
+    }
+    if (key == 'e') {                           //Klawisz 'e' zapisuje ostatnie pomiary do bin/data/trace.json (chrome://tracing)
+        ofDirectory::createDirectory(ofToDataPath("", true), false, true);
+        if (!FrameProfiler::global().exportChromeTrace(ofToDataPath("trace.json", true))) {
+            ofLogError("ofApp") << "Nie mozna zapisac trace.json";
+        }
+    }
+    if (key == 'k') {                           //Klawisz 'k' przełącza układ puli: Full / Compact / CompactHalf
+        scheduler->modify([](ParticleSystem<EmitterSet>& system) {
+            system.particles.setLayout(PoolLayout((int(system.particles.layout()) + 1) % 3));
+        });
+    }
+    if (key == 'm') {                           //Klawisz 'm' przełącza sposób rysowania cząstek
+        (world ? world->renderer : particleSystem->renderer).nextMode();
+    }
+    if (key == 't') {                           //Klawisz 't' przełącza aktualizację: jeden wątek / wszystkie rdzenie
+        scheduler->modify([](ParticleSystem<EmitterSet>& system) {
+            system.setThreadCount(system.threadCount() == 1 ? 0 : 1);
+        });
+    }
+    if (key == 'i') {                           //Klawisz 'i' przełącza oddziaływania między płatkami
+        scheduler->modify([](ParticleSystem<EmitterSet>& system) {
+            system.interactions.nextMode();
+        });
+    }
 }
 
 //--------------------------------------------------------------
@@ -5,37 +5,176 @@ void ofApp::setup() {
     ofSetFrameRate(60);
     ofBackground(0);
     ofEnableDepthTest(); // Włącza test głębi   - żeby cząstecki za kulą sie chowały a przed były widoczne
-//                          pozycja             predkosc               kolor                ilosc na sek, masa
-    Emitter emitter(ofVec3f(-300, -250, 0), ofVec3f(100, 100, 100), ofColor(200, 0, 40), 3.0f, 1000, 1.0f);
-    particleSystem = new ParticleSystem(emitter);
-
-    // Pozycja i promień kuli do kolizji
-    particleSystem->spherePosition = ofVec3f(0, 0, 0);
-    particleSystem->sphereRadius = 100.0f;
+    if (!sceneFile.open(ofToDataPath("scene.json", true))) {     // Parametry sceny - bez pliku zostają domyślne z Scenes.h
+        ofLogWarning("ofApp") << "scene.json: " << sceneFile.error() << " - domyslne parametry";
+    }
+    createSystem(0);                            // Aktualizacja na wszystkich rdzeniach
+    replayTime = 0;
+    lastRecordedStep = 0;
 }
 
 //--------------------------------------------------------------
 void ofApp::update(){                            //Aktualizuje logikę aplikacji
-    float dt = ofGetLastFrameTime();            //Oblicza czas między klatkami (dt w sekundach)
-    ofVec3f wind(2, 2, 0);                      //Wprowadza siłę wiatru (5 jednostek w prawo)
-    particleSystem->applyForce(wind);           //Dodaje siłę do każdej cząstki
-    particleSystem->update(dt);                 //Aktualizuje położenie i stan cząstek
+    if (sceneFile.poll()) {                     //Plik sceny zmieniony - nowe parametry dla działającego systemu
+        scheduler->modify([this](ParticleSystem<Emitter>& system) {
+            SceneConfig::apply(system, sceneFile.get());
+        });
+        wind = SceneConfig::wind(sceneFile.get(), Scenes::sparksWind());
+        ofLogNotice("ofApp") << "Wczytano scene.json";
+    }
+    scheduler->setForce(wind);                  //Wprowadza siłę wiatru - kroki symulacji (stałe dt) liczy wątek schedulera
+}
+
+//--------------------------------------------------------------
+void ofApp::createSystem(unsigned threads){     //Nowy system i scheduler: domyślne parametry z Scenes.h nadpisane plikiem sceny
+    particleSystem = new ParticleSystem<Emitter>(Scenes::sparksEmitter());
+    Scenes::setupSparks(*particleSystem);       // Kula do kolizji
+    SceneConfig::apply(*particleSystem, sceneFile.get(), true);
+    wind = SceneConfig::wind(sceneFile.get(), Scenes::sparksWind());
+    particleSystem->setThreadCount(threads);
+    scheduler = new FixedStepScheduler<ParticleSystem<Emitter>>(*particleSystem, Scenes::stepRate, Scenes::maxStepsPerFrame);
+    scheduler->start();                         // Od teraz system zmieniamy tylko przez scheduler->modify
+}
+
+//--------------------------------------------------------------
+void ofApp::exit(){
+    recorder.close();
+    delete scheduler;                           //Zatrzymuje wątek symulacji przed usunięciem systemu
+    delete particleSystem;
 }
 
 //--------------------------------------------------------------
 void ofApp::draw(){                             //Rysuje scenę
     cam.begin();                                //Aktywuje kamerę 3D
     ofDrawAxis(200);                            //Ośie układu współrzędnych
-    particleSystem->draw();                     //Rysuje wszystkie cząstki
+    drawParticles();                            //Symulacja albo odtwarzane nagranie
     cam.end();
+
+    drawStats();
+}
+
+//--------------------------------------------------------------
+void ofApp::drawParticles(){                    //Rysuje cząstki z symulacji (i nagrywa nowe stany) albo z nagrania
+    if (replay.isOpen()) {
+        replayTime += ofGetLastFrameTime();
+        if (replayTime > replay.frameTime(replay.frameCount() - 1)) {
+            replayTime = replay.frameTime(0);   //Nagranie odtwarzane w pętli
+        }
+        replay.readFrame(replay.frameAt(replayTime), replayPool);
+        particleSystem->draw(replayPool, 0);    //Bez symulacji - tylko rysowanie nagranego stanu
+        return;
+    }
+    scheduler->draw();                          //Rysuje wszystkie cząstki (interpolacja między krokami)
+    if (recorder.isOpen() && scheduler->renderedStep() != lastRecordedStep) {     //Nagrywany jest każdy nowy stan z symulacji
+        lastRecordedStep = scheduler->renderedStep();
+        recorder.addFrame(scheduler->renderedState(), lastRecordedStep * double(scheduler->getStepDt()));
+    }
+}
+
+//--------------------------------------------------------------
+void ofApp::toggleRecording(){                  //Włącza/wyłącza nagrywanie do bin/data/recording.prec
+    if (recorder.isOpen()) {
+        ofLogNotice("ofApp") << "Nagrano " << recorder.frameCount() << " klatek, " << recorder.bytesWritten() / 1024 << " KB";
+        recorder.close();
+        return;
+    }
+    ofDirectory::createDirectory(ofToDataPath("", true), false, true);
+    if (!recorder.open(ofToDataPath("recording.prec", true))) {
+        ofLogError("ofApp") << "Nie mozna zapisac recording.prec";
+    }
+}
+
+//--------------------------------------------------------------
+void ofApp::toggleReplay(){                     //Przełącza między symulacją a odtwarzaniem bin/data/recording.prec
+    if (replay.isOpen()) {
+        replay.close();
+        scheduler->start();                     //Symulacja rusza od stanu sprzed odtwarzania
+        return;
+    }
+    recorder.close();                           //Nagrywany plik musi być kompletny przed odczytem
+    if (!replay.open(ofToDataPath("recording.prec", true)) || replay.frameCount() == 0) {
+        ofLogError("ofApp") << "Brak nagrania recording.prec (c - nagrywanie)";
+        replay.close();
+        return;
+    }
+    scheduler->stop();                          //Przy odtwarzaniu symulacja nie jest liczona
+    replayTime = replay.frameTime(0);
+}
+
+//--------------------------------------------------------------
+void ofApp::drawStats(){                        //Tryb rysowania, liczba cząstek i czas klatki - do porównania trybów
+    ofDisableDepthTest();
+    std::string stats = "Tryb: " + std::string(ParticleRenderer::modeName(particleSystem->renderer.mode)) + " (m - zmiana)\n"
+                      + "Czastki: " + ofToString(replay.isOpen() ? replayPool.size() : scheduler->renderedCount()) + "\n"
+                      + "Watki: " + ofToString(particleSystem->threadCount()) + " (t - zmiana)\n"
+                      + "Pula: " + ParticlePool::layoutName(particleSystem->particles.layout()) + ", "
+                      + ofToString(ParticlePool::bytesPerParticle(particleSystem->particles.layout())) + " B na czastke (k - zmiana)\n"
+                      + "Krok: " + ofToString(int(Scenes::stepRate)) + " Hz, pominiete: " + ofToString(scheduler->getDroppedSteps()) + "\n"
+                      + "Klatka: " + ofToString(ofGetLastFrameTime() * 1000.0, 2) + " ms (" + ofToString(ofGetFrameRate(), 1) + " fps)";
+    if (recorder.isOpen()) {
+        stats += "\nNagrywanie: " + ofToString(recorder.frameCount()) + " klatek, " + ofToString(recorder.bytesWritten() / 1024) + " KB (c - stop)";
+    }
+    stats += "\nScena: " + (sceneFile.error().empty() ? "scene.json, wczytana " + ofToString(sceneFile.loadCount()) + " raz(y)"
+                                                    : "blad - " + sceneFile.error());
+    if (replay.isOpen()) {
+        stats += "\nOdtwarzanie: klatka " + ofToString(replay.frameAt(replayTime) + 1) + "/" + ofToString(replay.frameCount()) + " (p - powrot do symulacji)";
+    }
+    if (particleSystem->renderer.mode == RenderMode::Lod) {    //Koszyki LOD z ostatniej klatki
+        const LodBuckets& lod = particleSystem->renderer.lodBuckets();
+        stats += "\nLOD: kule " + ofToString(lod.meshes.size()) + ", punkty " + ofToString(lod.sprites.size())
+               + ", sub-piksel " + ofToString(lod.subPixel) + " w " + ofToString(lod.aggregates.size()) + " kafelkach"
+               + ", poza kadrem " + ofToString(lod.culled);
+    }
+    ofDrawBitmapStringHighlight(stats, 10, 20);
+    FrameProfiler& profiler = FrameProfiler::global();
+    if (profiler.enabled()) {                   //Nakładka profilera: p50/p99 etapów z ostatnich 2 s
+        profiler.collect();
+        size_t live = replay.isOpen() ? replayPool.size() : scheduler->renderedCount();
+        ofDrawBitmapStringHighlight(profiler.report(live) + "\n(f - ukryj, e - zapis trace.json)", ofGetWidth() - 300, 20);
+    }
+    ofEnableDepthTest();
 }
 
 //--------------------------------------------------------------
 void ofApp::keyPressed(int key){                //Obsługuje naciśnięcia klawiszy
     if (key == 'r') {                           //Klawisz 'r' resetuje system cząsteczek
+        RenderMode mode = particleSystem->renderer.mode;
+        unsigned threads = particleSystem->threadCount();
+        recorder.close();                       //Nagranie obejmuje jeden przebieg symulacji
+        lastRecordedStep = 0;
+        replay.close();                         //Reset kończy odtwarzanie - widać nową symulację, a nie nagranie
+        delete scheduler;                       //Najpierw zatrzymuje wątek symulacji
         delete particleSystem;                  //Usuwa istniejący system 
-        Emitter emitter(ofVec3f(-300, -250, 0), ofVec3f(100, 100, 100), ofColor(200, 0, 40), 3.0f, 1000, 1.0f);
-        particleSystem = new ParticleSystem(emitter);
+        createSystem(threads);                  //Ta sama scena co przy starcie (z bieżącym plikiem sceny)
+        particleSystem->renderer.mode = mode;   //Tryb rysowania i liczba wątków przetrwają reset
+    }
+    if (key == 'c') {                           //Klawisz 'c' włącza/wyłącza nagrywanie symulacji
+        toggleRecording();
+    }
+    if (key == 'p') {                           //Klawisz 'p' odtwarza nagranie (bez symulacji)
+        toggleReplay();
+    }
+    if (key == 'f') {                           //Klawisz 'f' włącza/wyłącza profiler i jego nakładkę
+        FrameProfiler::global().setEnabled(!FrameProfiler::global().enabled());
+    }
+    if (key == 'e') {                           //Klawisz 'e' zapisuje ostatnie pomiary do bin/data/trace.json (chrome://tracing)
+        ofDirectory::createDirectory(ofToDataPath("", true), false, true);
+        if (!FrameProfiler::global().exportChromeTrace(ofToDataPath("trace.json", true))) {
+            ofLogError("ofApp") << "Nie mozna zapisac trace.json";
+        }
+    }
+    if (key == 'k') {                           //Klawisz 'k' przełącza układ puli: Full / Compact / CompactHalf
+        scheduler->modify([](ParticleSystem<Emitter>& system) {
+            system.particles.setLayout(PoolLayout((int(system.particles.layout()) + 1) % 3));
+        });
+    }
+    if (key == 'm') {                           //Klawisz 'm' przełącza sposób rysowania cząstek
+        particleSystem->renderer.nextMode();
+    }
+    if (key == 't') {                           //Klawisz 't' przełącza aktualizację: jeden wątek / wszystkie rdzenie
+        scheduler->modify([](ParticleSystem<Emitter>& system) {
+            system.setThreadCount(system.threadCount() == 1 ? 0 : 1);
+        });
     }
 }
 
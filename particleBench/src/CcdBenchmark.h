@@ -0,0 +1,139 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ParticleSystem.h"
+#include "Emitter.h"
+#include "SimdKernels.h"
+#include "ParallelBenchmark.h"
+#include <chrono>
+#include <cmath>
+
+// Sprawdzenie ciągłej kolizji z kulą (SimdKernels::sweepSphere / kernel collideSphere)
+// 1) Przypadki przelatywania: pojedyncze cząstki przy dużym dt z oczekiwanym wynikiem, każda w 9 kopiach
+//    (pełne wektory SSE/AVX2 i reszta skalarna), dla każdego zestawu instrukcji.
+// 2) Scena z myParticleSystem z 20 razy większymi prędkościami i dt = 1/20 s (krok 2-3 razy dłuższy
+//    niż promień kuli): żaden odcinek ruchu cząstki między krokami nie może przejść przez kulę
+//    ani kończyć się w jej wnętrzu; wynik dla każdego zestawu instrukcji identyczny bit w bit.
+namespace CcdBenchmark {
+
+    struct Case {
+        const char* name;
+        ofVec3f start;                      //Pozycja na początku kroku
+        ofVec3f velocity;
+        float dt;
+        ofVec3f expectedPosition;           //Po kroku i kolizji
+        ofVec3f expectedVelocity;
+    };
+
+    // Najmniejsza odległość odcinka a -> b od środka kuli w (0, 0, 0)
+    inline float segmentDistance(const ofVec3f& a, const ofVec3f& b) {
+        ofVec3f d = b - a;
+        float len2 = d.lengthSquared();
+        float t = len2 > 0 ? std::min(std::max(-a.dot(d) / len2, 0.0f), 1.0f) : 0.0f;
+        return (a + d * t).length();
+    }
+
+    inline bool close(const ofVec3f& a, const ofVec3f& b, float tolerance) {
+        return (a - b).length() <= tolerance;
+    }
+
+    inline bool runCases() {
+        const float r = 100.0f;
+        const float s = std::sqrt(0.5f);
+        const Case cases[] = {
+            // Czołowo, krok 500 > średnica kuli: odbicie w x = -100 po 0.4 kroku, reszta kroku wstecz
+            { "head_on_tunnel", ofVec3f(-300, 0, 0), ofVec3f(30000, 0, 0), 1.0f / 60.0f, ofVec3f(-400, 0, 0), ofVec3f(-30000, 0, 0) },
+            // Tuż obok kuli - bez zmian
+            { "grazing_miss", ofVec3f(-300, 101, 0), ofVec3f(30000, 0, 0), 1.0f / 60.0f, ofVec3f(200, 101, 0), ofVec3f(30000, 0, 0) },
+            // Po przekątnej przez środek przy dt = 0.1 s: wejście w punkcie -r * (s, s), odbicie wstecz
+            { "diagonal_large_dt", ofVec3f(-200, -200, 0), ofVec3f(3000, 3000, 0), 0.1f,
+              ofVec3f(-r * s, -r * s, 0) - ofVec3f(3000, 3000, 0) * (0.1f - (200 - r * s) / 3000.0f), ofVec3f(-3000, -3000, 0) },
+            // Koniec kroku w kuli (zwykły przypadek dyskretny): też powrót do punktu zderzenia
+            { "end_inside", ofVec3f(-110, 0, 0), ofVec3f(1200, 0, 0), 1.0f / 60.0f, ofVec3f(-110, 0, 0), ofVec3f(-1200, 0, 0) },
+            // Cząstka w kuli od początku kroku: wypchnięcie na powierzchnię i odbicie
+            { "start_inside", ofVec3f(20, 0, 0), ofVec3f(-60, 0, 0), 1.0f / 60.0f, ofVec3f(100, 0, 0), ofVec3f(60, 0, 0) },
+            // Wychodzi z kuli - bez zmian
+            { "leaving", ofVec3f(90, 0, 0), ofVec3f(1200, 0, 0), 1.0f / 60.0f, ofVec3f(110, 0, 0), ofVec3f(1200, 0, 0) },
+            // Oddala się od kuli - bez zmian
+            { "moving_away", ofVec3f(150, 0, 0), ofVec3f(30000, 0, 0), 1.0f / 60.0f, ofVec3f(650, 0, 0), ofVec3f(30000, 0, 0) },
+        };
+
+        bool ok = true;
+        std::cout << "case\tisa\tposition\tvelocity\tok" << std::endl;
+        for (const Case& c : cases) {
+            for (int isa = 0; isa <= int(SimdKernels::Isa::AVX2); ++isa) {
+                if (!SimdKernels::isSupported(SimdKernels::Isa(isa))) continue;
+                const size_t n = 9;
+                ofVec3f end = c.start + c.velocity * c.dt;          //Stan po całkowaniu
+                std::vector<float> x(n, end.x), y(n, end.y), z(n, end.z), vx(n, c.velocity.x), vy(n, c.velocity.y), vz(n, c.velocity.z);
+                SimdKernels::table(SimdKernels::Isa(isa)).collideSphere(x.data(), y.data(), z.data(), vx.data(), vy.data(), vz.data(),
+                                                                        n, 0, 0, 0, r, c.dt);
+                bool caseOk = true;
+                for (size_t i = 0; i < n; ++i) {
+                    caseOk = caseOk && close(ofVec3f(x[i], y[i], z[i]), c.expectedPosition, 0.01f)
+                                    && close(ofVec3f(vx[i], vy[i], vz[i]), c.expectedVelocity, 0.01f)
+                                    && x[i] == x[0] && vx[i] == vx[0];
+                }
+                ok = ok && caseOk;
+                std::cout << c.name << "\t" << SimdKernels::isaName(SimdKernels::Isa(isa)) << "\t(" << x[0] << ", " << y[0] << ", " << z[0]
+                          << ")\t(" << vx[0] << ", " << vy[0] << ", " << vz[0] << ")\t" << caseOk << std::endl;
+            }
+        }
+        return ok;
+    }
+
+    // Scena iskier z dużymi prędkościami; zwraca stan po `steps` krokach, liczy odcinki przez kulę
+    inline ParticlePool runScene(SimdKernels::Isa isa, int steps, float dt, size_t& tunneled, size_t& inside, size_t& segments, double& nsPerParticle) {
+        SimdKernels::setActiveIsa(isa);
+        Emitter emitter(ofVec3f(-300, -250, 0), ofVec3f(2000, 2000, 2000), ofColor(200, 0, 40), 30.0f, 2000.0f, 1.0f, 1);
+        emitter.velocity = ofVec3f(2000, 1700, 0);                  //Strumień w stronę kuli
+        ParticleSystem<Emitter> system(emitter);
+        Scenes::setupSparks(system);
+        system.reapMode = ReapMode::StablePartition;                //Indeksy stałe (nikt nie umiera w czasie testu)
+
+        const float r = system.sphereRadius;
+        tunneled = inside = segments = 0;
+        double ns = 0;
+        size_t particleSteps = 0;
+        ParticlePool previous;
+        for (int s = 0; s < steps; ++s) {
+            previous = system.particles;
+            auto start = std::chrono::steady_clock::now();
+            system.update(dt);
+            ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+            particleSteps += system.particles.size();
+            for (size_t i = 0; i < previous.size(); ++i) {
+                ofVec3f a = previous.position(i), b = system.particles.position(i);
+                ++segments;
+                if (segmentDistance(a, b) < r * 0.999f) ++tunneled;
+                if (b.length() < r * 0.999f) ++inside;
+            }
+        }
+        nsPerParticle = ns / double(std::max<size_t>(particleSteps, 1));
+        return system.particles;
+    }
+
+    // Zwraca false, jeśli któryś przypadek daje zły wynik albo cząstka przeleciała przez kulę
+    inline bool run() {
+        const SimdKernels::Isa previousIsa = SimdKernels::activeIsa();
+        bool ok = runCases();
+
+        const int steps = 40;
+        const float dt = 1.0f / 20.0f;
+        std::cout << std::endl << "scene\tisa\tsegments\ttunneled\tends_inside\tupdate_ns_per_particle\tbit_exact" << std::endl;
+        ParticlePool reference;
+        for (int isa = 0; isa <= int(SimdKernels::Isa::AVX2); ++isa) {
+            if (!SimdKernels::isSupported(SimdKernels::Isa(isa))) continue;
+            size_t tunneled, inside, segments;
+            double ns;
+            ParticlePool pool = runScene(SimdKernels::Isa(isa), steps, dt, tunneled, inside, segments, ns);
+            if (isa == 0) reference = pool;
+            bool exact = ParallelBenchmark::samePool(reference, pool);
+            ok = ok && exact && tunneled == 0 && inside == 0;
+            std::cout << "fast_sparks_dt_1/20\t" << SimdKernels::isaName(SimdKernels::Isa(isa)) << "\t" << segments << "\t" << tunneled
+                      << "\t" << inside << "\t" << ns << "\t" << exact << std::endl;
+        }
+        SimdKernels::setActiveIsa(previousIsa);
+        return ok;
+    }
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "ofMain.h"
+#include "SphereColliderSet.h"
+#include "SimdKernels.h"
+#include <chrono>
+#include <cstring>
+#include <random>
+
+// Benchmark kolizji z wieloma kulami (SphereColliderSet)
+// 200 tys. cząstek w sześcianie 2000 x 2000 x 2000 i od 1 do 10 000 kul o promieniach 5-30.
+// Koszt na klatkę = przebudowa siatki (kule mogą się ruszać) + kolizje. Dla porównania
+// sprawdzanie każdej cząstki z każdą kulą (kernel collideSphere wywołany dla każdej kuli),
+// do 1000 kul; wynik siatki (pozycje i prędkości) jest porównywany bajt po bajcie z tym przeglądem.
+namespace ColliderBenchmark {
+
+    struct Particles {
+        std::vector<float> x, y, z, vx, vy, vz;
+    };
+
+    inline Particles makeParticles(size_t n) {
+        std::mt19937 rng(3);
+        std::uniform_real_distribution<float> pos(-1000, 1000), vel(-100, 100);
+        Particles p;
+        for (size_t i = 0; i < n; ++i) {
+            p.x.push_back(pos(rng)); p.y.push_back(pos(rng)); p.z.push_back(pos(rng));
+            p.vx.push_back(vel(rng)); p.vy.push_back(vel(rng)); p.vz.push_back(vel(rng));
+        }
+        return p;
+    }
+
+    inline bool sameState(const Particles& a, const Particles& b) {
+        const size_t bytes = a.vx.size() * sizeof(float);
+        return std::memcmp(a.x.data(), b.x.data(), bytes) == 0 && std::memcmp(a.y.data(), b.y.data(), bytes) == 0
+            && std::memcmp(a.z.data(), b.z.data(), bytes) == 0 && std::memcmp(a.vx.data(), b.vx.data(), bytes) == 0
+            && std::memcmp(a.vy.data(), b.vy.data(), bytes) == 0 && std::memcmp(a.vz.data(), b.vz.data(), bytes) == 0;
+    }
+
+    inline double millisSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Zwraca false, jeśli wynik siatki różni się od przeglądu wszystkich kul
+    inline bool run() {
+        const size_t particleCount = 200000;
+        const int frames = 10;
+        const float dt = 1.0f / 60.0f;
+        const Particles input = makeParticles(particleCount);
+        const SimdKernels::Table& kernels = SimdKernels::active();
+        bool allExact = true;
+
+        std::cout << "colliders\tcells\trebuild_ms\tgrid_collide_ms\tbrute_force_ms\tbit_exact" << std::endl;
+        for (size_t colliderCount = 1; colliderCount <= 10000; colliderCount *= 10) {
+            std::mt19937 rng(11);
+            std::uniform_real_distribution<float> pos(-1000, 1000), radius(5, 30);
+            SphereColliderSet colliders;
+            for (size_t i = 0; i < colliderCount; ++i) {
+                colliders.add(ofVec3f(pos(rng), pos(rng), pos(rng)), radius(rng));
+            }
+
+            Particles grid = input;
+            double rebuildMs = 0, collideMs = 0;
+            for (int f = 0; f < frames; ++f) {
+                colliders.setCenter(0, colliders[0].center);   //Jak przy ruchomych kulach - przebudowa co klatkę
+                auto start = std::chrono::steady_clock::now();
+                colliders.rebuild();
+                rebuildMs += millisSince(start);
+                start = std::chrono::steady_clock::now();
+                colliders.collide(grid.x.data(), grid.y.data(), grid.z.data(), grid.vx.data(), grid.vy.data(), grid.vz.data(),
+                                  particleCount, dt);
+                collideMs += millisSince(start);
+            }
+
+            std::cout << colliderCount << "\t" << colliders.cellCount() << "\t" << rebuildMs / frames << "\t"
+                      << collideMs / frames << "\t";
+            if (colliderCount <= 1000) {
+                Particles brute = input;
+                auto start = std::chrono::steady_clock::now();
+                for (int f = 0; f < frames; ++f) {
+                    for (size_t s = 0; s < colliderCount; ++s) {
+                        kernels.collideSphere(brute.x.data(), brute.y.data(), brute.z.data(),
+                                              brute.vx.data(), brute.vy.data(), brute.vz.data(), particleCount,
+                                              colliders[s].center.x, colliders[s].center.y, colliders[s].center.z,
+                                              colliders[s].radius, dt);
+                    }
+                }
+                bool exact = sameState(grid, brute);
+                allExact = allExact && exact;
+                std::cout << millisSince(start) / frames << "\t" << exact << std::endl;
+            } else {
+                std::cout << "-\t-" << std::endl;
+            }
+        }
+        return allExact;
+    }
+}
@@ -0,0 +1,248 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ParticleSystem.h"
+#include "EmitterSet.h"
+#include "Scenes.h"
+#include "SimdKernels.h"
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <random>
+
+// Benchmark układów puli (PoolLayout::Full / Compact / CompactHalf)
+// 1) Konwersje half: każdy zestaw instrukcji daje te same bity co halfFromFloat / floatFromHalf.
+// 2) Compact liczy to samo co Full bit w bit (rekord emitera zamiast pól cząstki);
+//    CompactHalf jest powtarzalny (ten sam wynik dla każdej liczby wątków i zestawu instrukcji),
+//    a odchylenie pozycji od Full jest raportowane.
+// 3) Pamięć na cząstkę (pojemność tablic puli) i czas aktualizacji dla 1 mln cząstek.
+// 4) 256 rekordów w użyciu: nowy rekord nie nadpisuje pól żywych cząstek - nowe cząstki są odrzucane,
+//    a po śmierci cząstek wolny rekord jest używany ponownie; konwersja z 257 rekordami zostawia układ Full.
+namespace CompactBenchmark {
+
+    inline bool sameBits(const std::vector<float>& a, const std::vector<float>& b) {
+        return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(float)) == 0;
+    }
+
+    // Ten sam stan niezależnie od układu: pozycje, prędkości, wiek i pola wspólne każdej cząstki
+    inline bool sameState(const ParticlePool& a, const ParticlePool& b) {
+        if (a.size() != b.size() || !sameBits(a.x, b.x) || !sameBits(a.y, b.y) || !sameBits(a.z, b.z) || !sameBits(a.age, b.age)) return false;
+        for (size_t i = 0; i < a.size(); ++i) {
+            ofVec3f va = a.velocity(i), vb = b.velocity(i);
+            if (std::memcmp(&va, &vb, sizeof(va)) != 0 || !(a.colorAt(i) == b.colorAt(i))
+                || a.lifetimeAt(i) != b.lifetimeAt(i) || a.invMassAt(i) != b.invMassAt(i) || a.flagsAt(i) != b.flagsAt(i)) return false;
+        }
+        return true;
+    }
+
+    inline bool checkConversions() {
+        std::vector<uint16_t> halves;
+        for (uint32_t h = 0; h < 0x10000; ++h) {
+            if (((h >> 10) & 0x1f) != 0x1f) halves.push_back(uint16_t(h));     //Bez inf/NaN - halfFromFloat ich nie daje
+        }
+        std::vector<float> floats;
+        for (uint64_t u = 0; u < (uint64_t(1) << 32); u += 4093) {           //Co 4093. wzorzec bitów float
+            uint32_t bits = uint32_t(u);
+            float f;
+            std::memcpy(&f, &bits, sizeof(f));
+            floats.push_back(f);
+        }
+
+        bool ok = true;
+        std::cout << "isa\tunpack_exact\tpack_exact\tround_trip\tpack_ns_per_value\tunpack_ns_per_value" << std::endl;
+        for (int isa = 0; isa <= int(SimdKernels::Isa::AVX2); ++isa) {
+            if (!SimdKernels::isSupported(SimdKernels::Isa(isa))) continue;
+            const SimdKernels::Table& k = SimdKernels::table(SimdKernels::Isa(isa));
+            std::vector<float> unpacked(halves.size());
+            std::vector<uint16_t> packed(floats.size()), back(halves.size());
+            auto start = std::chrono::steady_clock::now();
+            k.unpackHalf(halves.data(), unpacked.data(), halves.size());
+            double unpackNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / halves.size();
+            start = std::chrono::steady_clock::now();
+            k.packHalf(floats.data(), packed.data(), floats.size());
+            double packNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / floats.size();
+            k.packHalf(unpacked.data(), back.data(), unpacked.size());
+
+            bool unpackExact = true, packExact = true;
+            for (size_t i = 0; i < halves.size(); ++i) {
+                float f = SimdKernels::floatFromHalf(halves[i]);
+                unpackExact = unpackExact && std::memcmp(&f, &unpacked[i], sizeof(f)) == 0;
+            }
+            for (size_t i = 0; i < floats.size(); ++i) {
+                packExact = packExact && packed[i] == SimdKernels::halfFromFloat(floats[i]);
+            }
+            bool roundTrip = back == halves;
+            ok = ok && unpackExact && packExact && roundTrip;
+            std::cout << SimdKernels::isaName(SimdKernels::Isa(isa)) << "\t" << unpackExact << "\t" << packExact << "\t" << roundTrip
+                      << "\t" << packNs << "\t" << unpackNs << std::endl;
+        }
+        return ok;
+    }
+
+    inline ParticlePool christmas(PoolLayout layout, SimdKernels::Isa isa, unsigned threads, int steps) {
+        SimdKernels::setActiveIsa(isa);
+        ParticleSystem<EmitterSet> system(Scenes::christmasEmitters(4000));
+        Scenes::setupChristmas(system);
+        system.interactions.mode = InteractionMode::Clumping;      //Jak po klawiszu 'i' - oddziaływania też muszą dawać to samo
+        system.particles.setLayout(layout);
+        system.setThreadCount(threads);
+        for (int s = 0; s < steps; ++s) {
+            system.applyForce(Scenes::snowWind());
+            system.update(1.0f / Scenes::stepRate);
+        }
+        return system.particles;
+    }
+
+    inline ParticlePool sparks(PoolLayout layout, int steps) {
+        ParticleSystem<Emitter> system(Scenes::sparksEmitter());
+        Scenes::setupSparks(system);
+        system.particles.setLayout(layout);
+        system.setThreadCount(1);
+        for (int s = 0; s < steps; ++s) {
+            system.applyForce(Scenes::sparksWind());
+            system.update(1.0f / Scenes::stepRate);
+        }
+        return system.particles;
+    }
+
+    // Największe i średnie odchylenie pozycji CompactHalf od Full (te same indeksy - te same cząstki)
+    inline void positionError(const ParticlePool& full, const ParticlePool& half, float& maxError, float& meanError) {
+        maxError = meanError = 0;
+        const size_t n = std::min(full.size(), half.size());
+        for (size_t i = 0; i < n; ++i) {
+            float e = (full.position(i) - half.position(i)).length();
+            maxError = std::max(maxError, e);
+            meanError += e / float(std::max<size_t>(n, 1));
+        }
+    }
+
+    inline bool checkScenes() {
+        const SimdKernels::Isa best = SimdKernels::activeIsa();
+        const int steps = int(3 * Scenes::stepRate);
+
+        ParticlePool full = christmas(PoolLayout::Full, best, 0, steps);
+        ParticlePool compact = christmas(PoolLayout::Compact, best, 0, steps);
+        bool compactExact = sameState(full, compact);
+
+        ParticlePool half = christmas(PoolLayout::CompactHalf, best, 0, steps);
+        bool halfRepeatable = sameState(half, christmas(PoolLayout::CompactHalf, best, 1, steps))
+                           && sameState(half, christmas(PoolLayout::CompactHalf, SimdKernels::Isa::Scalar, 1, steps));
+        SimdKernels::setActiveIsa(best);
+        bool ok = compactExact && halfRepeatable && full.size() == half.size();
+
+        float maxChristmas, meanChristmas, maxSparks, meanSparks;
+        positionError(full, half, maxChristmas, meanChristmas);
+        positionError(sparks(PoolLayout::Full, steps), sparks(PoolLayout::CompactHalf, steps), maxSparks, meanSparks);
+
+        std::cout << std::endl << "check\tresult" << std::endl;
+        std::cout << "compact_equals_full_bit_exact\t" << compactExact << std::endl;
+        std::cout << "compact_half_same_for_threads_and_isa\t" << halfRepeatable << std::endl;
+        std::cout << "compact_half_position_error_sparks_3s (max / mean)\t" << maxSparks << " / " << meanSparks << std::endl;
+        std::cout << "compact_half_position_error_christmas_3s (max / mean)\t" << maxChristmas << " / " << meanChristmas
+                  << "\t(oddzialywania wzmacniaja roznice)" << std::endl;
+        return ok;
+    }
+
+    // Bajty tablic puli (pojemność) na jedną cząstkę pojemności
+    inline double measuredBytes(const ParticlePool& p) {
+        size_t bytes = (p.x.capacity() + p.y.capacity() + p.z.capacity() + p.vx.capacity() + p.vy.capacity() + p.vz.capacity()
+                        + p.age.capacity() + p.lifetime.capacity() + p.invMass.capacity()) * sizeof(float)
+                     + p.color.capacity() * sizeof(ofColor) + (p.flags.capacity() + p.emitterIndex.capacity()) * sizeof(uint8_t)
+                     + (p.hvx.capacity() + p.hvy.capacity() + p.hvz.capacity()) * sizeof(uint16_t)
+                     + p.emitterRecords.capacity() * sizeof(EmitterRecord);
+        return double(bytes) / double(p.capacity());
+    }
+
+    inline bool measureLayouts() {
+        const size_t n = 1000000;
+        const int steps = 20;
+        const PoolLayout layouts[] = { PoolLayout::Full, PoolLayout::Compact, PoolLayout::CompactHalf };
+        bool ok = true;
+        std::cout << std::endl << "layout\tbytes_per_particle\tpool_MB\tupdate_ns_per_particle" << std::endl;
+        for (PoolLayout layout : layouts) {
+            Emitter idle(ofVec3f(0, 0, 0), ofVec3f(0, 0, 0), ofColor(255, 255, 255), 100.0f, 0.0f, 1.0f);
+            ParticleSystem<Emitter> system(idle, n);
+            system.particles.setLayout(layout);
+            system.particles.allocate(n);
+            system.sphereRadius = 100.0f;
+            system.forces.addDrag(0.5f);
+            std::mt19937 rng(5);
+            std::uniform_real_distribution<float> pos(-1000, 1000), vel(-200, 200);
+            const ofColor colors[] = { ofColor(255, 255, 255), ofColor(150, 150, 150), ofColor(255, 140, 0) };
+            const float masses[] = { 1.0f, 4.0f, 2.0f };
+            for (size_t i = 0; i < n; ++i) {                //Trzy "emitery" jak w animacjaSwiateczna
+                system.particles.add(Particle(ofVec3f(pos(rng), pos(rng), pos(rng)), ofVec3f(vel(rng), vel(rng), vel(rng)),
+                                              colors[i % 3], 100.0f, masses[i % 3]));
+            }
+            system.update(1.0f / Scenes::stepRate);         //Rozgrzewka (strony pamięci, cache)
+            auto start = std::chrono::steady_clock::now();
+            for (int s = 0; s < steps; ++s) {
+                system.applyForce(ofVec3f(60, -120, 0));
+                system.update(1.0f / Scenes::stepRate);
+            }
+            double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (double(steps) * n);
+            double bytes = measuredBytes(system.particles);
+            if (layout == PoolLayout::CompactHalf) ok = ok && bytes < 24.0;
+            std::cout << ParticlePool::layoutName(layout) << "\t" << bytes << "\t" << bytes * n / (1024.0 * 1024.0) << "\t" << ns << std::endl;
+        }
+        return ok;
+    }
+
+    // Pola wszystkich cząstek (kolor, czas życia, 1/masa) - do porównania przed i po odrzuconej emisji
+    inline bool sameFields(const ParticlePool& a, const ParticlePool& b) {
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); ++i) {
+            if (!(a.colorAt(i) == b.colorAt(i)) || a.lifetimeAt(i) != b.lifetimeAt(i) || a.invMassAt(i) != b.invMassAt(i)
+                || a.flagsAt(i) != b.flagsAt(i)) return false;
+        }
+        return true;
+    }
+
+    inline bool checkRecordLimit() {
+        const size_t records = ParticlePool::maxRecords;
+        auto distinct = [](size_t i) {                  //Cząstka i - własny kolor, czas życia i masa
+            return Particle(ofVec3f(float(i), 0, 0), ofVec3f(0, 0, 0), ofColor(uint8_t(i), uint8_t(255 - i), 7), 10.0f + float(i), 1.0f + float(i));
+        };
+        ParticlePool pool;
+        pool.setLayout(PoolLayout::Compact);
+        for (size_t i = 0; i < records; ++i) pool.add(distinct(i));
+        const ParticlePool before = pool;
+
+        const Particle extra = distinct(records);
+        const bool addRejected = pool.add(extra) == ParticlePool::npos;
+        const size_t first = pool.spawn(5, extra.color, extra.lifetime, 1.0f / extra.mass);
+        const bool spawnRejected = first == pool.size();
+        const bool kept = pool.emitterRecords.size() == records && sameFields(pool, before);
+
+        pool.age[0] = std::numeric_limits<float>::infinity();     //Jedyna cząstka rekordu 0 umiera - rekord wolny
+        pool.reapDead(ReapMode::StablePartition);
+        const size_t added = pool.add(extra);
+        bool reused = added != ParticlePool::npos && pool.colorAt(added) == extra.color && pool.lifetimeAt(added) == extra.lifetime;
+        for (size_t i = 1; i < records; ++i) {
+            reused = reused && pool.colorAt(i - 1) == before.colorAt(i) && pool.lifetimeAt(i - 1) == before.lifetimeAt(i)
+                            && pool.invMassAt(i - 1) == before.invMassAt(i);
+        }
+
+        ParticlePool full;
+        for (size_t i = 0; i <= records; ++i) full.add(distinct(i));
+        const ParticlePool fullBefore = full;
+        const bool conversionRefused = !full.setLayout(PoolLayout::Compact) && full.layout() == PoolLayout::Full && sameState(full, fullBefore);
+
+        const bool ok = addRejected && spawnRejected && kept && reused && conversionRefused;
+        std::cout << std::endl << "records_full_keep_live_fields\t" << ok << "\t(add odrzucone " << addRejected << ", spawn odrzucone "
+                  << spawnRejected << ", pola bez zmian " << kept << ", wolny rekord ponownie " << reused
+                  << ", konwersja 257 rekordow odrzucona " << conversionRefused << ")" << std::endl;
+        return ok;
+    }
+
+    // Zwraca false, jeśli konwersje różnią się między zestawami instrukcji, Compact odbiega od Full,
+    // CompactHalf nie jest powtarzalny albo zajmuje 24 B lub więcej na cząstkę, albo pełna tablica rekordów
+    // zmienia pola żywych cząstek
+    inline bool run() {
+        bool ok = checkConversions();
+        ok = checkRecordLimit() && ok;
+        ok = checkScenes() && ok;
+        ok = measureLayouts() && ok;
+        return ok;
+    }
+}
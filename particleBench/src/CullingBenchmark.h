@@ -0,0 +1,65 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ParticleCulling.h"
+#include "Scenes.h"
+#include <chrono>
+
+// Benchmark odrzucania i LOD (ParticleCulling::classify)
+// Pole śniegu 2000 x 1000 x 2000 z animacjaSwiateczna, 1 mln płatków, kamera 1080p w kilku miejscach.
+// Dla każdego widoku: liczba cząstek w koszykach, czas klasyfikacji na cząstkę, liczba obiektów wysłanych
+// na GPU (bez LOD: wszystkie cząstki jako kule) i szacowana liczba pikseli do narysowania
+// (suma pól cząstek na ekranie, punkt zbiorczy = kafelek). Cząstki sub-pikselowe idą na GPU jako punkty
+// zbiorcze - ich liczba jest ograniczona liczbą kafelków ekranu, a nie liczbą cząstek.
+namespace CullingBenchmark {
+
+    inline void run() {
+        const size_t n = 1000000;
+        const float radius = 1.0f;              //Promień płatka jak w Scenes::setupSnow
+        const float viewportHeight = 1080.0f;
+
+        ParticlePool pool;
+        pool.allocate(n);
+        EmitterSnow emitter = Scenes::snowEmitter(float(n));
+        emitter.shape.halfExtent.y = 500.0f;
+        emitter.emit(1.0f, pool);
+
+        struct View { const char* name; ofVec3f eye; ofVec3f target; };
+        const View views[] = {
+            { "inside_field", ofVec3f(0, 0, 0), ofVec3f(0, 0, -1) },
+            { "edge_looking_in", ofVec3f(0, 300, 1200), ofVec3f(0, 300, 0) },
+            { "far_overview", ofVec3f(0, 2000, 4000), ofVec3f(0, 500, 0) },
+            { "looking_away", ofVec3f(0, 300, 1200), ofVec3f(0, 300, 2400) },
+        };
+
+        std::cout << "view\tmeshes\tsprites\tsub_pixel\taggregated_points\tculled\tclassify_ns_per_particle\tgpu_items_lod\tgpu_items_all\tpixels_lod" << std::endl;
+        LodBuckets buckets;
+        LodSettings lod;
+        for (const View& v : views) {
+            CullingView view = CullingView::perspective(v.eye, v.target, ofVec3f(0, 1, 0), 60.0f, 16.0f / 9.0f, 1.0f, 10000.0f, viewportHeight);
+            const int reps = 5;
+            auto start = std::chrono::steady_clock::now();
+            for (int r = 0; r < reps; ++r) {
+                ParticleCulling::classify(pool, radius, 0.0f, view, lod, buckets);
+            }
+            double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (double(reps) * n);
+
+            // Szacunek pikseli: pole koła o średnicy d px, co najmniej 1 px dla każdej rysowanej cząstki
+            double pixelsLod = 0;
+            for (uint32_t i : buckets.meshes) {
+                float w = view.depthRow[0] * pool.x[i] + view.depthRow[1] * pool.y[i] + view.depthRow[2] * pool.z[i] + view.depthRow[3];
+                float d = 2.0f * radius * view.pointScale / w;
+                pixelsLod += 0.785 * std::min(d, viewportHeight) * std::min(d, viewportHeight);
+            }
+            for (uint32_t i : buckets.sprites) {
+                float w = view.depthRow[0] * pool.x[i] + view.depthRow[1] * pool.y[i] + view.depthRow[2] * pool.z[i] + view.depthRow[3];
+                float d = 2.0f * radius * view.pointScale / w;
+                pixelsLod += std::max(1.0f, d * d);             //Punkt to kwadrat d x d (min 1 px)
+            }
+            pixelsLod += double(buckets.aggregates.size()) * lod.aggregateTile * lod.aggregateTile;
+            std::cout << v.name << "\t" << buckets.meshes.size() << "\t" << buckets.sprites.size() << "\t"
+                      << buckets.subPixel << "\t" << buckets.aggregates.size() << "\t" << buckets.culled << "\t" << ns << "\t"
+                      << buckets.gpuItems() << "\t" << n << "\t" << (long long)pixelsLod << std::endl;
+        }
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ParticleSystem.h"
+#include "Emitter.h"
+#include "Scenes.h"
+#include "AllocationCounter.h"
+
+// Benchmark emisji - sprawdza, czy klatka w stanie ustalonym nie alokuje pamięci
+// Każda scena jest symulowana ze stałym dt aż liczba cząstek się ustabilizuje
+// (czas życia + 1 s), potem liczone są alokacje w kolejnych `frames` klatkach.
+namespace EmitBenchmark {
+
+    const float dt = 1.0f / 60.0f;
+
+    // Zwraca liczbę alokacji w stanie ustalonym
+    template<class EmitterType>
+    uint64_t measure(const std::string& name, ParticleSystem<EmitterType>& system, const ofVec3f& wind, int frames) {
+        int warmupFrames = int((system.emitter.maxLifetime() + 1.0f) / dt);
+        for (int f = 0; f < warmupFrames; ++f) {
+            system.applyForce(wind);
+            system.update(dt);
+        }
+
+        uint64_t before = AllocationCounter::allocations();
+        for (int f = 0; f < frames; ++f) {
+            system.applyForce(wind);
+            system.update(dt);
+        }
+        uint64_t allocations = AllocationCounter::allocations() - before;
+
+        std::cout << name << "\t" << system.particles.size() << "\t" << system.particles.capacity()
+                  << "\t" << frames << "\t" << allocations << std::endl;
+        return allocations;
+    }
+
+    // Zwraca false, jeśli którakolwiek scena alokuje w stanie ustalonym
+    inline bool run() {
+        const int frames = 600;
+        std::cout << "scene\tlive_particles\tcapacity\tframes\tallocations" << std::endl;
+
+        uint64_t total = 0;
+        ParticleSystem<Emitter> sparks(Scenes::sparksEmitter());
+        Scenes::setupSparks(sparks);
+        total += measure("myParticleSystem", sparks, Scenes::sparksWind(), frames);
+
+        ParticleSystem<EmitterSnow> snow(Scenes::snowEmitter());
+        Scenes::setupSnow(snow);
+        total += measure("snow", snow, Scenes::snowWind(), frames);
+
+        ParticleSystem<EmitterSet> christmas(Scenes::christmasEmitters());
+        Scenes::setupChristmas(christmas);
+        total += measure("animacjaSwiateczna", christmas, Scenes::snowWind(), frames);
+        return total == 0;
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ForceFields.h"
+#include "ParticlePool.h"
+#include <chrono>
+#include <random>
+
+// Benchmark pól sił (ForceFieldStack)
+// Koszt na cząstkę dla każdego pola osobno oraz dla wszystkich pól razem: w jednym przejściu
+// (apply ze wszystkimi polami) i w osobnym przejściu na każde pole (dawne podejście - pętla na siłę).
+namespace ForceBenchmark {
+
+    inline double nsPerParticle(const ForceFieldStack& stack, ParticlePool& p, int reps) {
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < reps; ++r) {
+            stack.apply(p.x.data(), p.y.data(), p.z.data(), p.vx.data(), p.vy.data(), p.vz.data(),
+                        p.invMass.data(), p.size(), 1.0f / 60.0f);
+        }
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (double(reps) * p.size());
+    }
+
+    inline void run() {
+        const size_t n = 1 << 20;               //16 MB na 4 tablice pozycji/prędkości - więcej niż cache
+        const int reps = 5;
+
+        ParticlePool pool;
+        pool.allocate(n);
+        std::mt19937 rng(3);
+        std::uniform_real_distribution<float> pos(-500, 500), vel(-50, 50);
+        for (size_t i = 0; i < n; ++i) {
+            pool.add(Particle(ofVec3f(pos(rng), pos(rng), pos(rng)), ofVec3f(vel(rng), vel(rng), vel(rng)),
+                              ofColor(255, 255, 255), 5.0f, 1.0f));
+        }
+
+        ForceFieldStack all;
+        all.addGravity(ofVec3f(0, -98, 0));
+        all.addDrag(0.5f, 0.01f);
+        all.addAttractor(ofVec3f(0, 0, 0), 1000.0f, 300.0f);
+        all.addVortex(ofVec3f(0, 0, 0), ofVec3f(0, 1, 0), 50.0f, 400.0f);
+        all.addCurlNoise(40.0f, 0.004f, 0.3f);
+        const char* names[] = { "gravity", "drag", "attractor", "vortex", "curl_noise" };
+
+        std::cout << "field\tns_per_particle" << std::endl;
+        double separateNs = 0;
+        for (size_t f = 0; f < all.size(); ++f) {
+            ForceFieldStack single;
+            single.addGravity(ofVec3f(0, 0, 0));
+            single[0] = all[f];
+            double ns = nsPerParticle(single, pool, reps);
+            separateNs += ns;
+            std::cout << names[f] << "\t" << ns << std::endl;
+        }
+        double fusedNs = nsPerParticle(all, pool, reps);
+        std::cout << "\nall_fields\tns_per_particle" << std::endl;
+        std::cout << "separate_passes\t" << separateNs << "\nfused_pass\t" << fusedNs << std::endl;
+    }
+}
@@ -0,0 +1,174 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ParticleSystem.h"
+#include "EmitterSet.h"
+#include "Scenes.h"
+#include "ParallelBenchmark.h"
+#include <chrono>
+#include <cstring>
+
+// Benchmark GroundAccumulation - śnieg z animacjaSwiateczna osiada na ziemi zamiast leżeć w puli
+// 1) 20 s sceny: żywe cząstki z ziemią i bez niej, płatki zamienione na warstwę, wiersze siatki do wysłania na krok.
+// 2) Pamięć siatki (stała) w porównaniu z pamięcią cząstek, które leżałyby na ziemi, i koszt settle() na cząstkę.
+// 3) Masa śniegu: suma grubości w węzłach == osadzone płatki * depthPerParticle (bez limitu maxDepth),
+//    żadna żywa cząstka pod powierzchnią, ten sam wynik (pula i siatka) dla jednego i wszystkich wątków.
+// 4) Śnieg odkładają tylko cząstki emitera z flagą settles (w układzie Full i Compact): emiter bez flagi
+//    o tych samych polach nic nie dokłada, a płatki wyemitowane przed zmianą koloru (przeładowanie sceny) dalej osiadają.
+namespace GroundBenchmark {
+
+    inline void step(ParticleSystem<EmitterSet>& system) {
+        system.applyForce(Scenes::snowWind());
+        system.update(1.0f / Scenes::stepRate);
+    }
+
+    inline bool sameDepths(const GroundAccumulation& a, const GroundAccumulation& b) {
+        return a.depths().size() == b.depths().size()
+            && std::memcmp(a.depths().data(), b.depths().data(), a.depths().size() * sizeof(float)) == 0;
+    }
+
+    // Żywe cząstki nad siatką nie mogą być pod powierzchnią (settle usuwa je w tym samym kroku)
+    inline bool nothingBelow(const ParticleSystem<EmitterSet>& system) {
+        const GroundAccumulation& g = system.ground;
+        const float half = g.getSize() * 0.5f;
+        for (size_t i = 0; i < system.particles.size(); ++i) {
+            const float x = system.particles.x[i], z = system.particles.z[i];
+            if (std::abs(x - g.getCenter().x) > half || std::abs(z - g.getCenter().z) > half) continue;
+            if (system.particles.y[i] < g.heightAt(x, z) - 1e-3f) return false;
+        }
+        return true;
+    }
+
+    // Scena z ziemią i bez niej (ten sam śnieg); co sekundę wiersz
+    inline bool accumulate() {
+        const int seconds = 20;
+        ParticleSystem<EmitterSet> ground(Scenes::christmasEmitters());
+        Scenes::setupChristmas(ground);
+        ground.ground.maxDepth = 1e9f;                  //Bez limitu - sprawdzenie masy
+        ParticleSystem<EmitterSet> plain(Scenes::christmasEmitters());
+        Scenes::setupChristmas(plain);
+        plain.ground.setup(ofVec3f(0, 0, 0), 0, 0);     //Bez ziemi - płatki żyją do końca czasu życia
+
+        bool below = true;
+        size_t rows = 0, steps = 0;
+        std::cout << "t_s\tlive_with_ground\tlive_without\tdeposited\tremoved_on_ground\tmax_depth\trows_per_step" << std::endl;
+        for (int i = 1; i <= seconds * int(Scenes::stepRate); ++i) {
+            step(ground);
+            step(plain);
+            rows += ground.ground.refreshVertices();    //To, co draw() wysłałby w tej klatce (klatka = krok)
+            ++steps;
+            if (i % int(Scenes::stepRate) == 0) {
+                below = below && nothingBelow(ground);
+                std::cout << i / int(Scenes::stepRate) << "\t" << ground.particles.size() << "\t" << plain.particles.size() << "\t"
+                          << ground.ground.depositedCount() << "\t" << ground.ground.settledCount() << "\t" << ground.ground.maxSnowDepth()
+                          << "\t" << double(rows) / double(steps) << std::endl;
+                rows = steps = 0;
+            }
+        }
+
+        const GroundAccumulation& g = ground.ground;
+        const double expected = double(g.depositedCount()) * g.depthPerParticle;
+        const double error = std::abs(double(g.totalDepth()) - expected) / std::max(expected, 1.0);
+        const bool mass = g.depositedCount() > 0 && error < 1e-3;
+        const bool fewer = ground.particles.size() < plain.particles.size();
+
+        const size_t nodes = size_t(g.getResolution()) * size_t(g.getResolution());
+        const double gridKB = double(nodes * (2 * sizeof(float) + sizeof(glm::vec4))) / 1024.0;
+        const double particleBytes = ParticlePool::bytesPerParticle(ground.particles.layout());
+        std::cout << std::endl << "check\tresult" << std::endl;
+        std::cout << "snow_mass_conserved\t" << mass << "\t(suma grubosci " << g.totalDepth() << ", oczekiwana " << expected << ")" << std::endl;
+        std::cout << "no_live_particle_below_surface\t" << below << std::endl;
+        std::cout << "fewer_live_particles_with_ground\t" << fewer << "\t(" << ground.particles.size() << " / " << plain.particles.size() << ")" << std::endl;
+        std::cout << "ground_grid_KB (stala)\t" << gridKB << "\tsettled_flakes_as_particles_KB\t"
+                  << double(g.depositedCount()) * particleBytes / 1024.0 << std::endl;
+        return mass && below && fewer;
+    }
+
+    // Ten sam wynik - pula i warstwa śniegu - dla jednego i wszystkich wątków
+    inline bool threads() {
+        const int steps = int(6 * Scenes::stepRate);
+        ParticleSystem<EmitterSet> serial(Scenes::christmasEmitters(4000));
+        Scenes::setupChristmas(serial);
+        serial.setThreadCount(1);
+        ParticleSystem<EmitterSet> parallel(Scenes::christmasEmitters(4000));
+        Scenes::setupChristmas(parallel);
+        parallel.setThreadCount(0);
+        for (int s = 0; s < steps; ++s) {
+            step(serial);
+            step(parallel);
+        }
+        const bool same = ParallelBenchmark::samePool(serial.particles, parallel.particles) && sameDepths(serial.ground, parallel.ground)
+                       && serial.ground.depositedCount() > 0;
+        std::cout << "same_for_1_and_all_threads\t" << same << "\t(" << serial.ground.depositedCount() << " platkow na ziemi)" << std::endl;
+        return same;
+    }
+
+    // Sam śnieg (z flagą albo bez) przez 6 s; po 3 s emiter zmienia kolor jak przy przeładowaniu pliku sceny
+    inline void snowOnly(PoolLayout layout, bool settles, size_t& deposited, size_t& settled) {
+        EmitterSnow snow = Scenes::snowEmitter();
+        snow.lifetime = 8.0f;                           //Jak w Scenes::christmasEmitters
+        snow.settles = settles;
+        EmitterSet emitters;
+        emitters.add(snow);
+        ParticleSystem<EmitterSet> system(emitters);
+        Scenes::setupChristmas(system);
+        system.particles.setLayout(layout);
+        for (int i = 0; i < int(6 * Scenes::stepRate); ++i) {
+            if (i == int(3 * Scenes::stepRate)) dynamic_cast<ShapeEmitter<BoxShape>&>(system.emitter[0]).color = ofColor(200, 0, 40);
+            step(system);
+        }
+        deposited = system.ground.depositedCount();
+        settled = system.ground.settledCount();
+    }
+
+    inline bool identity() {
+        const PoolLayout layouts[] = { PoolLayout::Full, PoolLayout::Compact };
+        bool ok = true;
+        for (PoolLayout layout : layouts) {
+            size_t twinDeposited, twinSettled, snowDeposited, snowSettled;
+            snowOnly(layout, false, twinDeposited, twinSettled);
+            snowOnly(layout, true, snowDeposited, snowSettled);
+            const bool same = twinDeposited == 0 && twinSettled > 0 && snowDeposited == snowSettled && snowSettled > 0;
+            ok = ok && same;
+            std::cout << "only_settling_emitter_deposits_" << ParticlePool::layoutName(layout) << "\t" << same << "\t(bez flagi: "
+                      << twinDeposited << " / " << twinSettled << ", z flaga i zmiana koloru: " << snowDeposited << " / " << snowSettled << ")" << std::endl;
+        }
+        return ok;
+    }
+
+    // Koszt settle() na cząstkę puli i koszt przesłania całej siatki
+    inline void cost() {
+        ParticleSystem<EmitterSet> system(Scenes::christmasEmitters(4000));
+        Scenes::setupChristmas(system);
+        for (int s = 0; s < int(3 * Scenes::stepRate); ++s) {
+            step(system);
+        }
+        GroundAccumulation g;
+        g.setup(system.ground.getCenter(), system.ground.getSize(), system.ground.getResolution(), system.ground.getHillHeight());
+        ParticlePool pool = system.particles;
+        const int repeats = 50;
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < repeats; ++r) {
+            g.settle(pool);
+        }
+        const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count()
+                        / (double(repeats) * double(std::max<size_t>(pool.size(), 1)));
+        start = std::chrono::steady_clock::now();
+        g.clear();                                      //Wszystkie wiersze zmienione
+        const size_t rows = g.refreshVertices();
+        const double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "settle_ns_per_particle\t" << ns << "\t(" << pool.size() << " czastek)" << std::endl;
+        std::cout << "full_grid_refresh_us\t" << us << "\t(" << rows << " wierszy, "
+                  << rows * size_t(g.getResolution()) * sizeof(glm::vec4) / 1024 << " KB)" << std::endl;
+    }
+
+    // Zwraca false, jeśli śnieg nie jest zachowany, cząstka zostaje pod ziemią, ziemia nie zmniejsza puli,
+    // wynik zależy od liczby wątków albo śnieg odkłada emiter bez flagi settles
+    inline bool run() {
+        bool ok = accumulate();
+        ok = threads() && ok;
+        ok = identity() && ok;
+        cost();
+        return ok;
+    }
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ParticleSystem.h"
+#include "Emitter.h"
+#include "Scenes.h"
+#include "AllocationCounter.h"
+#include "ProcessStats.h"
+#include <chrono>
+#include <cstdlib>
+
+// Symulacja bez okna i bez OpenGL - ParticleSystem::update ze stałym dt przez N kroków
+// Dla każdej sceny i szybkości emisji wypisuje jedną linię JSON (JSON Lines) na stdout:
+//   ns_per_particle_step - czas update (z applyForce) na jedną żywą cząstkę w jednym kroku
+//   peak_live            - największa liczba żywych cząstek
+//   setup_allocations    - alokacje przy tworzeniu systemu (pula, wątki)
+//   step_allocations     - alokacje we wszystkich krokach (powinno być 0)
+//   rss_kb, peak_rss_kb  - pamięć procesu po przebiegu
+//
+// Opcje (klucz=wartość): steps=600 dt=0.0166667 threads=0 scene=all|sparks|snow|christmas
+//                        rates=1000,10000,100000,1000000
+namespace HeadlessBenchmark {
+
+    struct Options {
+        int steps = 600;
+        float dt = 1.0f / 60.0f;
+        unsigned threads = 0;               //0 = wszystkie rdzenie
+        std::string scene = "all";
+        std::vector<float> rates = { 1e3f, 1e4f, 1e5f, 1e6f };
+    };
+
+    inline Options parse(int argc, char* argv[], int first) {
+        Options options;
+        for (int i = first; i < argc; ++i) {
+            std::string arg = argv[i];
+            size_t eq = arg.find('=');
+            if (eq == std::string::npos) continue;
+            std::string key = arg.substr(0, eq);
+            std::string value = arg.substr(eq + 1);
+            if (key == "steps") options.steps = std::atoi(value.c_str());
+            else if (key == "dt") options.dt = float(std::atof(value.c_str()));
+            else if (key == "threads") options.threads = unsigned(std::atoi(value.c_str()));
+            else if (key == "scene") options.scene = value;
+            else if (key == "rates") {
+                options.rates.clear();
+                std::istringstream list(value);
+                std::string rate;
+                while (std::getline(list, rate, ',')) {
+                    options.rates.push_back(float(std::atof(rate.c_str())));
+                }
+            }
+        }
+        return options;
+    }
+
+    template<class EmitterType, class Setup>
+    void runScene(const std::string& name, float rate, const EmitterType& emitter, Setup setup, const ofVec3f& wind,
+                  const Options& options) {
+        uint64_t allocationsBefore = AllocationCounter::allocations();
+        ParticleSystem<EmitterType> system(emitter);
+        setup(system);
+        system.setThreadCount(options.threads);
+        uint64_t setupAllocations = AllocationCounter::allocations() - allocationsBefore;
+
+        double totalNs = 0.0;
+        double particleSteps = 0.0;
+        size_t peakLive = 0;
+        allocationsBefore = AllocationCounter::allocations();
+        for (int step = 0; step < options.steps; ++step) {
+            auto start = std::chrono::steady_clock::now();
+            system.applyForce(wind);
+            system.update(options.dt);
+            auto end = std::chrono::steady_clock::now();
+            totalNs += std::chrono::duration<double, std::nano>(end - start).count();
+            particleSteps += double(system.particles.size());
+            peakLive = std::max(peakLive, system.particles.size());
+        }
+        uint64_t stepAllocations = AllocationCounter::allocations() - allocationsBefore;
+
+        std::cout << "{\"scene\":\"" << name << "\""
+                  << ",\"rate\":" << (long long)rate
+                  << ",\"steps\":" << options.steps
+                  << ",\"dt\":" << options.dt
+                  << ",\"threads\":" << system.threadCount()
+                  << ",\"ns_per_particle_step\":" << (particleSteps > 0 ? totalNs / particleSteps : 0.0)
+                  << ",\"ms_per_step\":" << totalNs / options.steps / 1e6
+                  << ",\"peak_live\":" << peakLive
+                  << ",\"setup_allocations\":" << setupAllocations
+                  << ",\"step_allocations\":" << stepAllocations
+                  << ",\"rss_kb\":" << ProcessStats::currentRssKb()
+                  << ",\"peak_rss_kb\":" << ProcessStats::peakRssKb()
+                  << "}" << std::endl;
+    }
+
+    inline void run(int argc, char* argv[], int first) {
+        Options options = parse(argc, argv, first);
+        for (float rate : options.rates) {
+            if (options.scene == "all" || options.scene == "sparks") {
+                runScene("sparks", rate, Scenes::sparksEmitter(rate), Scenes::setupSparks, Scenes::sparksWind(), options);
+            }
+            if (options.scene == "all" || options.scene == "snow") {
+                runScene("snow", rate, Scenes::snowEmitter(rate), Scenes::setupSnow, Scenes::snowWind(), options);
+            }
+            if (options.scene == "all" || options.scene == "christmas") {
+                runScene("christmas", rate, Scenes::christmasEmitters(rate), Scenes::setupChristmas, Scenes::snowWind(), options);
+            }
+        }
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ParticleInteractions.h"
+#include <chrono>
+#include <random>
+
+// Benchmark oddziaływań cząstka-cząstka (SpatialHash + ParticleInteractions)
+// 100 tys. płatków w warstwie 400 x 40 x 400 (jak zaspa) i promień oddziaływania 6.
+// Mierzona jest osobno budowa siatki i pełne apply() dla każdego trybu, w porównaniu
+// z budżetem klatki 60 fps. Sąsiedzi z siatki są porównywani z przeglądem wszystkich par (próbka cząstek).
+namespace NeighbourBenchmark {
+
+    inline double millisSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Liczba sąsiadów z siatki == przegląd wszystkich cząstek, dla co setnej cząstki
+    inline bool matchesBruteForce(const ParticlePool& pool, const SpatialHash& hash, float radius) {
+        for (size_t i = 0; i < pool.size(); i += 100) {
+            size_t fromHash = 0, brute = 0;
+            hash.forEachCandidate(pool.x[i], pool.y[i], pool.z[i], [&](uint32_t, float jx, float jy, float jz) {
+                float dx = jx - pool.x[i], dy = jy - pool.y[i], dz = jz - pool.z[i];
+                fromHash += dx * dx + dy * dy + dz * dz < radius * radius;
+            });
+            for (size_t j = 0; j < pool.size(); ++j) {
+                float dx = pool.x[j] - pool.x[i], dy = pool.y[j] - pool.y[i], dz = pool.z[j] - pool.z[i];
+                brute += dx * dx + dy * dy + dz * dz < radius * radius;
+            }
+            if (fromHash != brute) return false;
+        }
+        return true;
+    }
+
+    // Zwraca false, jeśli siatka gubi sąsiadów (przekroczenie budżetu jest tylko raportowane)
+    inline bool run(unsigned threads) {
+        const size_t n = 100000;
+        const float radius = 6.0f;
+        const int frames = 20;
+        const double frameBudgetMs = 1000.0 / 60.0;
+
+        ParticlePool pool;
+        pool.allocate(n);
+        std::mt19937 rng(5);
+        std::uniform_real_distribution<float> xz(-200, 200), y(0, 40);
+        for (size_t i = 0; i < n; ++i) {
+            pool.add(Particle(ofVec3f(xz(rng), y(rng), xz(rng)), ofVec3f(0, 0, 0), ofColor(255, 255, 255), 5.0f, 1.0f));
+        }
+
+        std::unique_ptr<JobSystem> jobs;
+        if (threads != 1) jobs.reset(new JobSystem(threads));
+
+        // Średnia liczba sąsiadów w promieniu - gęstość sceny
+        SpatialHash hash;
+        auto start = std::chrono::steady_clock::now();
+        for (int f = 0; f < frames; ++f) {
+            hash.build(pool.x.data(), pool.y.data(), pool.z.data(), n, radius);
+        }
+        double buildMs = millisSince(start) / frames;
+        size_t neighbours = 0;
+        for (size_t i = 0; i < n; ++i) {
+            hash.forEachCandidate(pool.x[i], pool.y[i], pool.z[i], [&](uint32_t j, float jx, float jy, float jz) {
+                float dx = jx - pool.x[i], dy = jy - pool.y[i], dz = jz - pool.z[i];
+                neighbours += (j != i && dx * dx + dy * dy + dz * dz < radius * radius);
+            });
+        }
+
+        const bool matches = matchesBruteForce(pool, hash, radius);
+        std::cout << "particles\t" << n << "\nthreads\t" << (jobs ? jobs->threadCount() : 1)
+                  << "\nmean_neighbours\t" << double(neighbours) / n << "\nbuild_ms\t" << buildMs
+                  << "\nneighbours_match_brute_force\t" << matches << std::endl;
+        std::cout << "mode\tapply_ms\tframe_budget_ms\twithin_budget" << std::endl;
+        const InteractionMode modes[] = { InteractionMode::Repulsion, InteractionMode::Clumping, InteractionMode::Density };
+        for (InteractionMode mode : modes) {
+            ParticleInteractions interactions;
+            interactions.mode = mode;
+            interactions.radius = radius;
+            ParticlePool work = pool;
+            start = std::chrono::steady_clock::now();
+            for (int f = 0; f < frames; ++f) {
+                interactions.apply(work, 1.0f / 60.0f, jobs.get());
+            }
+            double ms = millisSince(start) / frames;
+            std::cout << ParticleInteractions::modeName(mode) << "\t" << ms << "\t" << frameBudgetMs << "\t"
+                      << (ms < frameBudgetMs) << std::endl;
+        }
+        return matches;
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ParticleSystem.h"
+#include "Emitter.h"
+#include "Scenes.h"
+#include <chrono>
+#include <cstring>
+
+// Benchmark równoległej aktualizacji (ParticleSystem::setThreadCount)
+// Scena z myParticleSystem (emiter punktowy + kula) z dużą szybkością emisji. Dla każdej liczby
+// wątków symulacja startuje z tym samym ziarnem emitera, a końcowy stan puli jest porównywany
+// bajt po bajcie ze stanem z aktualizacji szeregowej.
+namespace ParallelBenchmark {
+
+    const float dt = 1.0f / 60.0f;
+
+    inline bool samePool(const ParticlePool& a, const ParticlePool& b) {
+        if (a.size() != b.size()) return false;
+        const size_t bytes = a.size() * sizeof(float);
+        return std::memcmp(a.x.data(), b.x.data(), bytes) == 0 && std::memcmp(a.y.data(), b.y.data(), bytes) == 0
+            && std::memcmp(a.z.data(), b.z.data(), bytes) == 0 && std::memcmp(a.vx.data(), b.vx.data(), bytes) == 0
+            && std::memcmp(a.vy.data(), b.vy.data(), bytes) == 0 && std::memcmp(a.vz.data(), b.vz.data(), bytes) == 0
+            && std::memcmp(a.age.data(), b.age.data(), bytes) == 0;
+    }
+
+    // Symuluje `frames` klatek i zwraca średni czas update w milisekundach
+    inline double simulate(ParticleSystem<Emitter>& system, int frames) {
+        double totalMs = 0.0;
+        for (int f = 0; f < frames; ++f) {
+            auto start = std::chrono::steady_clock::now();
+            system.applyForce(Scenes::sparksWind());
+            system.update(dt);
+            auto end = std::chrono::steady_clock::now();
+            totalMs += std::chrono::duration<double, std::milli>(end - start).count();
+        }
+        return totalMs / frames;
+    }
+
+    // Zwraca false, jeśli wynik równoległy różni się od szeregowego
+    inline bool run() {
+        const float rate = 200000;
+        const int frames = 240;                 //4 s - pula w stanie ustalonym (czas życia 3 s)
+        Emitter emitter = Scenes::sparksEmitter(rate);
+
+        ParticleSystem<Emitter> reference(emitter);
+        Scenes::setupSparks(reference);
+        double serialMs = simulate(reference, frames);
+
+        std::cout << "threads\tlive_particles\tms_per_update\tspeedup\tbit_exact" << std::endl;
+        std::cout << 1 << "\t" << reference.particles.size() << "\t" << serialMs << "\t1\t1" << std::endl;
+
+        bool allExact = true;
+        unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned threads = 2; threads <= std::max(hardware, 4u); threads *= 2) {     //Co najmniej 2 i 4 wątki - sprawdzenie zgodności także na słabych maszynach
+            ParticleSystem<Emitter> system(emitter);
+            Scenes::setupSparks(system);
+            system.setThreadCount(threads);
+            double ms = simulate(system, frames);
+            bool exact = samePool(reference.particles, system.particles);
+            allExact = allExact && exact;
+            std::cout << threads << "\t" << system.particles.size() << "\t" << ms << "\t" << serialMs / ms
+                      << "\t" << exact << std::endl;
+        }
+        return allExact;
+    }
+}
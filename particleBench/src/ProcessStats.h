@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <fstream>
+#include <sstream>
+#include <string>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+// Zużycie pamięci procesu (RSS) - do raportów benchmarków
+namespace ProcessStats {
+
+    // Wartość pola z /proc/self/status (Linux), w kilobajtach; 0 gdy brak
+    inline size_t procStatusKb(const std::string& field) {
+        std::ifstream status("/proc/self/status");
+        std::string line;
+        while (std::getline(status, line)) {
+            if (line.compare(0, field.size(), field) == 0 && line.size() > field.size() && line[field.size()] == ':') {
+                std::istringstream value(line.substr(field.size() + 1));
+                size_t kb = 0;
+                value >> kb;
+                return kb;
+            }
+        }
+        return 0;
+    }
+
+    inline size_t currentRssKb() {          //Bieżące RSS (tylko Linux, inaczej 0)
+        return procStatusKb("VmRSS");
+    }
+
+    inline size_t peakRssKb() {             //Szczytowe RSS od startu procesu
+        size_t kb = procStatusKb("VmHWM");
+#if defined(__unix__) || defined(__APPLE__)
+        if (kb == 0) {
+            struct rusage usage;
+            if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#if defined(__APPLE__)
+                kb = size_t(usage.ru_maxrss) / 1024;    //macOS podaje bajty
+#else
+                kb = size_t(usage.ru_maxrss);
+#endif
+            }
+        }
+#endif
+        return kb;
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ParticleSystem.h"
+#include "EmitterSet.h"
+#include "Scenes.h"
+#include "FrameProfiler.h"
+#include <chrono>
+
+// Benchmark FrameProfiler na scenie z animacjaSwiateczna
+// Ten sam przebieg (4 s po 120 kroków) z wyłączonym i włączonym profilerem - narzut pomiaru -
+// potem tabela p50/p99 etapów jak na nakładce w aplikacji i ślad do chrome://tracing.
+// Użycie: particleBench profile [plik.json]   (domyślnie particleBench_trace.json)
+namespace ProfileBenchmark {
+
+    inline double simulateMs(int steps, unsigned threads, size_t& live) {
+        ParticleSystem<EmitterSet> system(Scenes::christmasEmitters(4000));
+        Scenes::setupChristmas(system);
+        system.setThreadCount(threads);
+        const float dt = 1.0f / Scenes::stepRate;
+        auto start = std::chrono::steady_clock::now();
+        for (int s = 0; s < steps; ++s) {
+            system.applyForce(Scenes::snowWind());
+            system.update(dt);
+            if (s % 2 == 1) {
+                FrameProfiler::global().collect();      //Jak nakładka w aplikacji - co klatkę 60 Hz
+            }
+        }
+        live = system.particles.size();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / steps;
+    }
+
+    inline void run(const std::string& tracePath) {
+        const int steps = int(4 * Scenes::stepRate);
+        FrameProfiler& profiler = FrameProfiler::global();
+
+        size_t live = 0;
+        profiler.setEnabled(false);
+        double offMs = simulateMs(steps, 0, live);
+        profiler.setEnabled(true);
+        double onMs = simulateMs(steps, 0, live);
+        profiler.collect();
+
+        std::cout << "profiler\tupdate_ms" << std::endl;
+        std::cout << "off\t" << offMs << std::endl;
+        std::cout << "on\t" << onMs << "\t(" << 100.0 * (onMs - offMs) / offMs << "% narzutu)" << std::endl;
+        std::cout << std::endl << profiler.report(live) << std::endl;
+        std::cout << "zdarzenia: " << profiler.eventCount() << ", utracone: " << profiler.getLostEvents() << std::endl;
+
+        if (profiler.exportChromeTrace(tracePath)) {
+            std::cout << "slad: " << tracePath << std::endl;
+        } else {
+            std::cerr << "Nie mozna zapisac " << tracePath << std::endl;
+        }
+        profiler.setEnabled(false);
+    }
+}
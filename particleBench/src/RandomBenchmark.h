@@ -0,0 +1,76 @@
+#pragma once
+
+#include "ofMain.h"
+#include "Emitter.h"
+#include "Scenes.h"
+#include "RandomStream.h"
+#include "ParallelBenchmark.h"
+#include <chrono>
+
+// Benchmark losowania przy emisji
+// Porównuje 6 wywołań ofRandom na cząstkę (dawny Emitter::emit) z RandomStream::fill dla całych tablic,
+// mierzy EmitterSnow::emit przy 10^6 cząstek/s i sprawdza powtarzalność: ten sam seed -> ta sama pula.
+namespace RandomBenchmark {
+
+    inline double nsPerParticle(std::chrono::steady_clock::time_point start, size_t particles) {
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / particles;
+    }
+
+    // Emituje `frames` klatek po dt z pustej puli przed każdą klatką; zwraca ostatnią pulę
+    inline ParticlePool emitFrames(EmitterSnow emitter, int frames, float dt) {
+        ParticlePool pool;
+        pool.allocate(size_t(emitter.emissionRate * dt) + 1);
+        for (int f = 0; f < frames; ++f) {
+            pool.clear();
+            emitter.emit(dt, pool);
+        }
+        return pool;
+    }
+
+    // Zwraca false, jeśli ten sam seed nie daje tej samej puli
+    inline bool run() {
+        const size_t n = 1 << 20;
+        std::vector<float> a(n), b(n), c(n), d(n), e(n), f(n);
+        volatile float sink = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < n; ++i) {
+            a[i] = ofRandom(-500, 500); b[i] = ofRandom(-500, 500); c[i] = ofRandom(-500, 500);
+            d[i] = ofRandom(-1, 1); e[i] = ofRandom(-1, 1); f[i] = ofRandom(-1, 1);
+        }
+        double ofRandomNs = nsPerParticle(start, n);
+        sink = a[n / 2];
+
+        RandomStream random(1);
+        start = std::chrono::steady_clock::now();
+        random.fill(a.data(), n, -500, 500); random.fill(b.data(), n, -500, 500); random.fill(c.data(), n, -500, 500);
+        random.fill(d.data(), n, -1, 1); random.fill(e.data(), n, -1, 1); random.fill(f.data(), n, -1, 1);
+        double streamNs = nsPerParticle(start, n);
+        sink = a[n / 2];
+        (void)sink;
+
+        std::cout << "generator\tns_per_particle (6 liczb)" << std::endl;
+        std::cout << "ofRandom\t" << ofRandomNs << "\nRandomStream::fill\t" << streamNs << std::endl;
+
+        // Emisja 10^6 cząstek/s w klatkach po 1/60 s
+        const float dt = 1.0f / 60.0f;
+        const int frames = 120;
+        EmitterSnow emitter = Scenes::snowEmitter(1000000);
+        start = std::chrono::steady_clock::now();
+        ParticlePool pool = emitFrames(emitter, frames, dt);
+        double msPerFrame = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / frames;
+        std::cout << "\nemit_rate\tparticles_per_frame\tms_per_frame" << std::endl;
+        std::cout << 1000000 << "\t" << pool.size() << "\t" << msPerFrame << std::endl;
+
+        // Powtarzalność: ten sam seed -> identyczna pula, inny strumień -> inna
+        ParticlePool again = emitFrames(Scenes::snowEmitter(1000000), frames, dt);
+        EmitterSnow other = Scenes::snowEmitter(1000000);
+        other.random.seed(2, 1);
+        ParticlePool otherPool = emitFrames(other, frames, dt);
+        bool replay = ParallelBenchmark::samePool(pool, again);
+        bool independent = !ParallelBenchmark::samePool(pool, otherPool);
+        std::cout << "\nsame_seed_identical\tother_stream_differs" << std::endl;
+        std::cout << replay << "\t" << independent << std::endl;
+        return replay && independent;
+    }
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ParticlePool.h"
+#include <chrono>
+#include <random>
+
+// Benchmark usuwania martwych cząstek (ParticlePool::reapDead)
+// Pula ma stałą liczbę żywych cząstek o czasie życia 3 s i równomiernie rozłożonym wieku,
+// więc przy dt = 1/60 s w każdej klatce umiera ok. 1/180 z nich - tak jak w Emitter.
+// Mierzony jest tylko koszt usuwania, starzenie i dopełnianie puli są poza pomiarem.
+namespace ReapBenchmark {
+
+    const float lifetime = 3.0f;
+    const float dt = 1.0f / 60.0f;
+
+    inline void fill(ParticlePool& pool, size_t n, std::mt19937& rng) {
+        std::uniform_real_distribution<float> ageDist(0.0f, lifetime);
+        while (pool.size() < n) {
+            size_t i = pool.add(Particle(ofVec3f(0, 0, 0), ofVec3f(1, 1, 1), ofColor(255, 255, 255), lifetime, 1.0f));
+            pool.age[i] = ageDist(rng);
+        }
+    }
+
+    // Stara metoda z ParticleSystem::update - erase dla każdej martwej cząstki (punkt odniesienia)
+    inline size_t reapErase(ParticlePool& pool) {
+        size_t removed = 0;
+        for (size_t i = 0; i < pool.size();) {
+            if (pool.isDead(i)) {
+                pool.x.erase(pool.x.begin() + i); pool.y.erase(pool.y.begin() + i); pool.z.erase(pool.z.begin() + i);
+                pool.vx.erase(pool.vx.begin() + i); pool.vy.erase(pool.vy.begin() + i); pool.vz.erase(pool.vz.begin() + i);
+                pool.age.erase(pool.age.begin() + i);
+                pool.lifetime.erase(pool.lifetime.begin() + i);
+                pool.invMass.erase(pool.invMass.begin() + i);
+                pool.color.erase(pool.color.begin() + i);
+                pool.flags.erase(pool.flags.begin() + i);
+                ++removed;
+            } else {
+                ++i;
+            }
+        }
+        return removed;
+    }
+
+    // Zwraca średni czas usuwania w mikrosekundach na klatkę; `mode` < 0 oznacza starą metodę erase
+    inline double measure(size_t liveCount, int mode, int frames, double& deadPerFrame) {
+        std::mt19937 rng(1234);
+        ParticlePool pool;
+        pool.reserve(liveCount);
+        fill(pool, liveCount, rng);
+
+        double totalMicros = 0.0;
+        size_t totalDead = 0;
+        for (int f = 0; f < frames; ++f) {
+            for (size_t i = 0; i < pool.size(); ++i) {
+                pool.age[i] += dt;
+            }
+            auto start = std::chrono::steady_clock::now();
+            if (mode < 0) {
+                totalDead += reapErase(pool);
+            } else {
+                totalDead += pool.reapDead(static_cast<ReapMode>(mode));
+            }
+            auto end = std::chrono::steady_clock::now();
+            totalMicros += std::chrono::duration<double, std::micro>(end - start).count();
+            fill(pool, liveCount, rng);     //Nowe cząstki mają losowy wiek, żeby rozkład śmierci był stały
+        }
+        deadPerFrame = double(totalDead) / frames;
+        return totalMicros / frames;
+    }
+
+    inline void run() {
+        const size_t counts[] = { 10000, 100000, 1000000 };
+        const char* names[] = { "SwapAndPop", "StablePartition" };
+
+        std::cout << "live_particles\tmode\tus_per_frame\tdead_per_frame" << std::endl;
+        for (size_t n : counts) {
+            int frames = n >= 1000000 ? 20 : 60;
+            double dead = 0.0;
+            for (int mode = 0; mode < 2; ++mode) {
+                double us = measure(n, mode, frames, dead);
+                std::cout << n << "\t" << names[mode] << "\t" << us << "\t" << dead << std::endl;
+            }
+            if (n <= 100000) {                  //Erase przy milionie cząstek trwałby minuty
+                double us = measure(n, -1, frames, dead);
+                std::cout << n << "\tvector::erase\t" << us << "\t" << dead << std::endl;
+            }
+        }
+    }
+}
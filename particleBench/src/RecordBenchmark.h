@@ -0,0 +1,132 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ParticleSystem.h"
+#include "EmitterSet.h"
+#include "Scenes.h"
+#include "SimulationRecording.h"
+#include "ParallelBenchmark.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+
+// Benchmark nagrywania i odtwarzania (SimulationRecorder / SimulationReplay)
+// Scena z animacjaSwiateczna (śnieg, dym, iskry), 6 s po 60 klatek, każda klatka nagrywana.
+// Raport: bajty na cząstkę i klatkę (stan bez kompresji: 16 B), czas kodowania i dekodowania na cząstkę.
+// Sprawdzenie: odtworzona klatka ma te same kolory i liczbę cząstek, a pozycje różnią się najwyżej
+// o pół kroku kwantyzacji; skok do dowolnej klatki daje to samo co odtwarzanie po kolei.
+// Uszkodzona klatka (liczba cząstek większa niż dane) i klatka większa niż pojemność puli dają false bez alokacji.
+namespace RecordBenchmark {
+
+    inline double ns(std::chrono::steady_clock::duration d) {
+        return std::chrono::duration<double, std::nano>(d).count();
+    }
+
+    // Plik z jedną klatką: nagłówek z liczbą cząstek `count` i `payload` bajtami zer
+    inline void writeFrame(const std::string& path, uint32_t count, uint32_t payload) {
+        using namespace SimulationRecording;
+        FileHeader file = { { 'P', 'R', 'E', 'C' }, version, 64.0f, 1 };
+        FrameHeader frame = { count, payload, 0.0 };
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&file), sizeof(file));
+        out.write(reinterpret_cast<const char*>(&frame), sizeof(frame));
+        const std::vector<char> zeros(payload, 0);
+        out.write(zeros.data(), std::streamsize(zeros.size()));
+    }
+
+    inline bool checkDamagedFrames(const std::string& path) {
+        SimulationReplay replay;
+        ParticlePool pool;
+        writeFrame(path, 0xFFFFFFFFu, 8);               //4 mld cząstek w 8 bajtach
+        const bool hugeCount = replay.open(path) && replay.frameCount() == 1 && !replay.readFrame(0, pool) && pool.size() == 0;
+        replay.close();
+
+        writeFrame(path, 100, 400);                     //100 cząstek w miejscu (same zera), pula na 50
+        ParticlePool small;
+        small.allocate(50);
+        const bool overCapacity = replay.open(path) && !replay.readFrame(0, small) && small.size() == 0
+                               && replay.readFrame(0, pool) && pool.size() == 100;
+        replay.close();
+        std::remove(path.c_str());
+        std::cout << "damaged_frames_rejected\t" << (hugeCount && overCapacity) << "\t(liczba > dane " << hugeCount
+                  << ", klatka > pojemnosc puli " << overCapacity << ")" << std::endl;
+        return hugeCount && overCapacity;
+    }
+
+    inline bool run() {
+        const std::string path = "particleBench_recording.prec";
+        const int frames = 360;
+        const float dt = 1.0f / 60.0f;
+        const float resolution = 64.0f;
+
+        ParticleSystem<EmitterSet> system(Scenes::christmasEmitters(4000));
+        Scenes::setupChristmas(system);
+        system.setThreadCount(0);
+
+        SimulationRecorder recorder;
+        if (!recorder.open(path, resolution)) {
+            std::cerr << "Nie mozna zapisac " << path << std::endl;
+            return false;
+        }
+        std::vector<ParticlePool> reference;            //Co 30. klatka - do porównania z odtworzeniem
+        std::chrono::steady_clock::duration encodeTime(0);
+        for (int f = 0; f < frames; ++f) {
+            system.applyForce(Scenes::snowWind());
+            system.update(dt);
+            auto start = std::chrono::steady_clock::now();
+            recorder.addFrame(system.particles, f * double(dt));
+            encodeTime += std::chrono::steady_clock::now() - start;
+            if (f % 30 == 29) reference.push_back(system.particles);
+        }
+        recorder.close();
+        const double particles = double(recorder.particlesWritten());
+
+        SimulationReplay replay;
+        if (!replay.open(path) || replay.frameCount() != size_t(frames)) {
+            std::cerr << "Nie mozna odczytac " << path << std::endl;
+            return false;
+        }
+
+        // Odtwarzanie po kolei, porównanie z zapamiętanymi klatkami
+        ParticlePool pool;
+        std::vector<ParticlePool> sequential;
+        std::chrono::steady_clock::duration decodeTime(0);
+        float maxError = 0;
+        bool ok = true;
+        for (int f = 0; f < frames; ++f) {
+            auto start = std::chrono::steady_clock::now();
+            ok = replay.readFrame(f, pool) && ok;
+            decodeTime += std::chrono::steady_clock::now() - start;
+            if (f % 30 != 29) continue;
+            sequential.push_back(pool);
+            const ParticlePool& ref = reference[f / 30];
+            ok = ok && ref.size() == pool.size();
+            for (size_t i = 0; ok && i < ref.size(); ++i) {
+                maxError = std::max(maxError, std::fabs(ref.x[i] - pool.x[i]));
+                maxError = std::max(maxError, std::fabs(ref.y[i] - pool.y[i]));
+                maxError = std::max(maxError, std::fabs(ref.z[i] - pool.z[i]));
+                ok = ok && ref.color[i] == pool.color[i];
+            }
+        }
+        // Błąd zaokrąglenia: pół kroku plus błąd float przy współrzędnych do ok. 2000
+        const float bound = 0.5f / resolution + 2048.0f * 1.2e-7f;
+        ok = ok && maxError <= bound;
+
+        // Skoki wstecz i między klatkami kluczowymi
+        bool seekExact = true;
+        for (size_t k = sequential.size(); k-- > 0;) {
+            seekExact = replay.readFrame(30 * k + 29, pool) && ParallelBenchmark::samePool(sequential[k], pool) && seekExact;
+        }
+        ok = ok && seekExact;
+        replay.close();
+        std::remove(path.c_str());
+
+        std::cout << "frames\tavg_particles\tbytes_per_particle_frame\traw_bytes_per_particle\tencode_ns_per_particle\t"
+                     "decode_ns_per_particle\tmax_error\terror_bound\tseek_exact" << std::endl;
+        std::cout << frames << "\t" << size_t(particles / frames) << "\t" << recorder.bytesWritten() / particles << "\t"
+                  << SimulationRecording::rawBytesPerParticle << "\t" << ns(encodeTime) / particles << "\t"
+                  << ns(decodeTime) / particles << "\t" << maxError << "\t" << bound << "\t" << seekExact << std::endl;
+        ok = checkDamagedFrames(path) && ok;
+        return ok;
+    }
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ParticleSystem.h"
+#include "EmitterSet.h"
+#include "Scenes.h"
+#include "SceneConfig.h"
+#include "ParallelBenchmark.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
+// Sprawdzenie plików scen (SceneConfig / SceneFile)
+// 1) bin/data/scene.json obu aplikacji opisuje te same sceny co Scenes.h - symulacja (i śnieg na ziemi) bit w bit taka sama.
+// 2) Przeładowanie w trakcie działania: zmiana pliku trafia do działającego systemu bez nowej puli
+//    (żywe cząstki zostają, tablice nie są alokowane od nowa), plik z błędem zostawia poprzednią scenę,
+//    a inna lista emiterów buduje zestaw od nowa.
+// Użycie: particleBench scene [katalog repozytorium]   (domyślnie bieżący)
+namespace SceneBenchmark {
+
+    inline bool samePreset(ParticleSystem<Emitter>& a, ParticleSystem<Emitter>& b, const ofVec3f& windA, const ofVec3f& windB) {
+        for (int s = 0; s < 360; ++s) {
+            a.applyForce(windA);
+            a.update(1.0f / Scenes::stepRate);
+            b.applyForce(windB);
+            b.update(1.0f / Scenes::stepRate);
+        }
+        return ParallelBenchmark::samePool(a.particles, b.particles) && a.particles.capacity() == b.particles.capacity();
+    }
+
+    inline bool samePreset(ParticleSystem<EmitterSet>& a, ParticleSystem<EmitterSet>& b, const ofVec3f& windA, const ofVec3f& windB) {
+        for (int s = 0; s < 360; ++s) {
+            a.applyForce(windA);
+            a.update(1.0f / Scenes::stepRate);
+            b.applyForce(windB);
+            b.update(1.0f / Scenes::stepRate);
+        }
+        bool same = ParallelBenchmark::samePool(a.particles, b.particles) && a.particles.capacity() == b.particles.capacity()
+                 && a.ground.depths() == b.ground.depths() && a.ground.depositedCount() == b.ground.depositedCount();
+        for (size_t i = 0; same && i < a.particles.size(); ++i) {
+            same = a.particles.color[i] == b.particles.color[i] && a.particles.invMass[i] == b.particles.invMass[i];
+        }
+        return same;
+    }
+
+    inline bool writeFile(const std::string& path, const std::string& text) {
+        std::ofstream out(path, std::ios::trunc);
+        out << text;
+        out.close();
+        //Czas modyfikacji przesunięty o sekundę - system plików z grubą rozdzielczością czasu też zauważy zmianę
+        std::error_code ec;
+        std::filesystem::last_write_time(path, std::filesystem::last_write_time(path, ec) + std::chrono::seconds(1), ec);
+        return bool(out);
+    }
+
+    inline bool pollAfterInterval(SceneFile& file) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));    //Dłużej niż odstęp sprawdzania pliku
+        return file.poll();
+    }
+
+    inline bool run(const std::string& root) {
+        bool ok = true;
+        std::cout << "check\tok" << std::endl;
+
+        // 1) Pliki scen aplikacji == Scenes.h
+        SceneFile sparksFile, christmasFile;
+        bool loaded = sparksFile.open(root + "/myParticleSystem/bin/data/scene.json")
+                   && christmasFile.open(root + "/animacjaSwiateczna/bin/data/scene.json");
+        std::cout << "load_app_scenes\t" << loaded << (loaded ? "" : "\t" + sparksFile.error() + christmasFile.error()) << std::endl;
+        if (!loaded) return false;
+        {
+            ParticleSystem<Emitter> preset(Scenes::sparksEmitter());
+            Scenes::setupSparks(preset);
+            ParticleSystem<Emitter> fromFile(Scenes::sparksEmitter());
+            Scenes::setupSparks(fromFile);
+            SceneConfig::apply(fromFile, sparksFile.get(), true);
+            bool same = samePreset(preset, fromFile, Scenes::sparksWind(), SceneConfig::wind(sparksFile.get(), ofVec3f(0, 0, 0)));
+            ok = ok && same;
+            std::cout << "sparks_file_matches_preset\t" << same << std::endl;
+        }
+        {
+            ParticleSystem<EmitterSet> preset(Scenes::christmasEmitters());
+            Scenes::setupChristmas(preset);
+            ParticleSystem<EmitterSet> fromFile(Scenes::christmasEmitters());
+            Scenes::setupChristmas(fromFile);
+            SceneConfig::apply(fromFile, christmasFile.get(), true);
+            bool same = samePreset(preset, fromFile, Scenes::snowWind(), SceneConfig::wind(christmasFile.get(), ofVec3f(0, 0, 0)));
+            ok = ok && same;
+            std::cout << "christmas_file_matches_preset\t" << same << std::endl;
+        }
+
+        // 2) Przeładowanie działającej sceny
+        const std::string path = "particleBench_scene.json";
+        ofJson scene = christmasFile.get();
+        writeFile(path, scene.dump(4));
+        SceneFile watched;
+        watched.open(path);
+        ParticleSystem<EmitterSet> system(Scenes::christmasEmitters());
+        Scenes::setupChristmas(system);
+        SceneConfig::apply(system, watched.get(), true);
+        for (int s = 0; s < 240; ++s) {
+            system.update(1.0f / Scenes::stepRate);
+        }
+        const float* data = system.particles.x.data();
+        const size_t capacity = system.particles.capacity();
+        const size_t live = system.particles.size();
+        const EmitterBase* smoke = &system.emitter[1];
+
+        // Zmiana w miejscu: kolor i szybkość dymu, wiatr - bez zmiany listy emiterów
+        scene["emitters"][1]["color"] = { 20, 200, 60 };
+        scene["emitters"][1]["rate"] = 100;
+        scene["wind"] = { -200, 0, 0 };
+        writeFile(path, scene.dump(4));
+        bool reloaded = pollAfterInterval(watched);
+        auto start = std::chrono::steady_clock::now();
+        SceneConfig::apply(system, watched.get());
+        double applyUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        bool inPlace = reloaded && system.particles.x.data() == data && system.particles.capacity() == capacity
+                    && system.particles.size() == live && &system.emitter[1] == smoke;
+        for (int s = 0; s < 30; ++s) {
+            system.update(1.0f / Scenes::stepRate);
+        }
+        bool newColor = false;
+        for (size_t i = 0; i < system.particles.size(); ++i) {
+            newColor = newColor || system.particles.color[i] == ofColor(20, 200, 60);
+        }
+        bool windChanged = SceneConfig::wind(watched.get(), ofVec3f(0, 0, 0)).x == -200;
+        ok = ok && inPlace && newColor && windChanged;
+        std::cout << "reload_in_place\t" << inPlace << "\t(" << applyUs << " us)" << std::endl;
+        std::cout << "reload_new_particles_use_new_color\t" << newColor << std::endl;
+        std::cout << "reload_wind\t" << windChanged << std::endl;
+
+        // Plik z błędem: poprzednia scena zostaje, błąd do wyświetlenia
+        writeFile(path, "{ \"wind\": [1, 2, ");
+        bool broken = !pollAfterInterval(watched) && !watched.error().empty()
+                   && SceneConfig::wind(watched.get(), ofVec3f(0, 0, 0)).x == -200;
+        ok = ok && broken;
+        std::cout << "broken_file_keeps_scene\t" << broken << std::endl;
+
+        // Inna lista emiterów (bez iskier) - zestaw od nowa, pula ta sama
+        scene["emitters"].erase(2);
+        writeFile(path, scene.dump(4));
+        reloaded = pollAfterInterval(watched) && watched.error().empty();
+        SceneConfig::apply(system, watched.get());
+        bool rebuilt = reloaded && system.emitter.size() == 2 && system.particles.x.data() == data;
+        ok = ok && rebuilt;
+        std::cout << "emitter_list_change\t" << rebuilt << std::endl;
+
+        std::remove(path.c_str());
+        return ok;
+    }
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ParticleSystem.h"
+#include "Emitter.h"
+#include "Scenes.h"
+#include "FixedStepScheduler.h"
+#include "ParallelBenchmark.h"
+#include <chrono>
+#include <random>
+
+// Benchmark FixedStepScheduler na scenie z myParticleSystem
+// 1) Ten sam czas rzeczywisty podzielony na klatki 30, 60, 144 fps i na klatki o losowej długości
+//    musi dać stan puli identyczny bit w bit - fizyka nie zależy od liczby klatek.
+// 2) Przycięcie klatki o 0.5 s wykonuje najwyżej maxStepsPerFrame kroków, a resztę czasu pomija.
+// 3) Wątek symulacji przez 0.5 s - liczba kroków na sekundę (tylko informacyjnie).
+namespace SchedulerBenchmark {
+
+    typedef ParticleSystem<Emitter> System;
+
+    // Symuluje `seconds` czasu rzeczywistego w klatkach z `frameDts` (powtarzanych w kółko)
+    inline void simulate(System& system, const std::vector<double>& frameDts, double seconds) {
+        FixedStepScheduler<System> scheduler(system, Scenes::stepRate, Scenes::maxStepsPerFrame);
+        scheduler.setForce(Scenes::sparksWind());
+        double time = 0;
+        for (size_t f = 0; time < seconds; ++f) {
+            double frameDt = std::min(frameDts[f % frameDts.size()], seconds - time);
+            scheduler.advance(frameDt);
+            time += frameDt;
+        }
+    }
+
+    inline bool run() {
+        const double seconds = 2.0 + 0.5 / Scenes::stepRate;  //Pół kroku zapasu na błędy zaokrągleń sumy klatek
+        bool ok = true;
+
+        System reference(Scenes::sparksEmitter());
+        Scenes::setupSparks(reference);
+        simulate(reference, { 1.0 / 60.0 }, seconds);
+
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<double> jitter(0.004, 0.040);
+        std::vector<double> jittered(256);
+        for (double& dt : jittered) dt = jitter(rng);
+
+        std::cout << "frames\tlive_particles\tbit_exact_vs_60fps" << std::endl;
+        const char* names[] = { "30fps", "144fps", "jitter_4-40ms" };
+        const std::vector<double> frameDts[] = { { 1.0 / 30.0 }, { 1.0 / 144.0 }, jittered };
+        for (int i = 0; i < 3; ++i) {
+            System system(Scenes::sparksEmitter());
+            Scenes::setupSparks(system);
+            simulate(system, frameDts[i], seconds);
+            bool same = ParallelBenchmark::samePool(reference.particles, system.particles);
+            ok = ok && same;
+            std::cout << names[i] << "\t" << system.particles.size() << "\t" << same << std::endl;
+        }
+
+        // Przycięcie klatki: 1 s przy 60 fps, potem klatka 0.5 s
+        System system(Scenes::sparksEmitter());
+        Scenes::setupSparks(system);
+        FixedStepScheduler<System> scheduler(system, Scenes::stepRate, Scenes::maxStepsPerFrame);
+        scheduler.setForce(Scenes::sparksWind());
+        for (int f = 0; f < 60; ++f) {
+            scheduler.advance(1.0 / 60.0);
+        }
+        auto start = std::chrono::steady_clock::now();
+        int hitchSteps = scheduler.advance(0.5);
+        double hitchMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        ok = ok && hitchSteps <= Scenes::maxStepsPerFrame;
+        std::cout << "\nhitch_frame_s\tsteps\tmax_steps\tdropped_steps\tms" << std::endl;
+        std::cout << 0.5 << "\t" << hitchSteps << "\t" << Scenes::maxStepsPerFrame << "\t"
+                  << scheduler.getDroppedSteps() << "\t" << hitchMs << std::endl;
+
+        // Wątek symulacji
+        System threaded(Scenes::sparksEmitter());
+        Scenes::setupSparks(threaded);
+        FixedStepScheduler<System> background(threaded, Scenes::stepRate, Scenes::maxStepsPerFrame);
+        background.setForce(Scenes::sparksWind());
+        background.start();
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        background.stop();
+        std::cout << "\nthread_steps_per_s\ttarget\tdropped_steps" << std::endl;
+        std::cout << background.getStepCount() * 2 << "\t" << Scenes::stepRate << "\t" << background.getDroppedSteps() << std::endl;
+        return ok;
+    }
+}
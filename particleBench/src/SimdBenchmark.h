@@ -0,0 +1,85 @@
+#pragma once
+
+#include "ofMain.h"
+#include "SimdKernels.h"
+#include <chrono>
+#include <cstring>
+#include <random>
+
+// Mikrobenchmark kerneli SimdKernels - cząstki na sekundę dla każdego zestawu instrukcji
+// Dane: milion cząstek wokół kuli o promieniu 100 (jak w myParticleSystem), ok. połowa w jej wnętrzu.
+// Wynik każdej wersji jest porównywany bajt po bajcie z wersją skalarną.
+namespace SimdBenchmark {
+
+    struct Data {
+        std::vector<float> x, y, z, vx, vy, vz, age, lifetime, invMass;
+
+        explicit Data(size_t n) : x(n), y(n), z(n), vx(n), vy(n), vz(n), age(n), lifetime(n), invMass(n) {
+            std::mt19937 rng(7);
+            std::uniform_real_distribution<float> pos(-126, 126), vel(-100, 100), life(0, 3);
+            for (size_t i = 0; i < n; ++i) {
+                x[i] = pos(rng); y[i] = pos(rng); z[i] = pos(rng);
+                vx[i] = vel(rng); vy[i] = vel(rng); vz[i] = vel(rng);
+                age[i] = life(rng); lifetime[i] = 3.0f; invMass[i] = 1.0f;
+            }
+        }
+
+        bool operator==(const Data& o) const {
+            const size_t bytes = x.size() * sizeof(float);
+            return std::memcmp(x.data(), o.x.data(), bytes) == 0 && std::memcmp(y.data(), o.y.data(), bytes) == 0
+                && std::memcmp(z.data(), o.z.data(), bytes) == 0 && std::memcmp(vx.data(), o.vx.data(), bytes) == 0
+                && std::memcmp(vy.data(), o.vy.data(), bytes) == 0 && std::memcmp(vz.data(), o.vz.data(), bytes) == 0
+                && std::memcmp(age.data(), o.age.data(), bytes) == 0;
+        }
+    };
+
+    // Wywołuje kernel `reps` razy na kopii danych; zwraca cząstki na sekundę
+    template<class Kernel>
+    double measure(const Data& input, Data& output, int reps, Kernel kernel) {
+        output = input;
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < reps; ++r) {
+            kernel(output);
+        }
+        auto end = std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration<double>(end - start).count();
+        return double(input.x.size()) * reps / seconds;
+    }
+
+    // Zwraca false, jeśli któraś wersja daje inny wynik niż skalarna
+    inline bool run() {
+        const size_t n = 1000000;
+        const int reps = 50;
+        const float dt = 1.0f / 60.0f;
+        Data input(n);
+        bool allExact = true;
+
+        std::cout << "kernel\tisa\tparticles_per_second\tbit_exact" << std::endl;
+        const char* kernels[] = { "collideSphere", "integrate", "applyForce", "countDead" };
+        for (int k = 0; k < 4; ++k) {
+            Data reference(0);
+            for (int isa = 0; isa <= int(SimdKernels::Isa::AVX2); ++isa) {
+                if (!SimdKernels::isSupported(SimdKernels::Isa(isa))) continue;
+                const SimdKernels::Table& t = SimdKernels::table(SimdKernels::Isa(isa));
+                Data output(0);
+                size_t dead = 0;
+                double rate = measure(input, output, reps, [&](Data& d) {
+                    switch (k) {
+                        case 0: t.collideSphere(d.x.data(), d.y.data(), d.z.data(), d.vx.data(), d.vy.data(), d.vz.data(),
+                                                n, 0, 0, 0, 100.0f, dt); break;
+                        case 1: t.integrate(d.x.data(), d.y.data(), d.z.data(), d.vx.data(), d.vy.data(), d.vz.data(),
+                                            d.age.data(), n, dt); break;
+                        case 2: t.applyForce(d.vx.data(), d.vy.data(), d.vz.data(), d.invMass.data(), n, 2, 2, 0); break;
+                        case 3: dead += t.countDead(d.age.data(), d.lifetime.data(), n); break;
+                    }
+                });
+                if (isa == 0) reference = output;
+                bool exact = output == reference;
+                allExact = allExact && exact;
+                std::cout << kernels[k] << "\t" << SimdKernels::isaName(SimdKernels::Isa(isa)) << "\t" << rate
+                          << "\t" << exact << std::endl;
+            }
+        }
+        return allExact;
+    }
+}
@@ -0,0 +1,280 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ChunkedWorld.h"
+#include "Scenes.h"
+#include "ParallelBenchmark.h"
+#include "CompactBenchmark.h"
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <tuple>
+
+// Benchmark ChunkedWorld - śnieg z animacjaSwiateczna na świecie bez granic
+// 1) Strona kawałka (ChunkPage) w każdym układzie puli wraca z dysku bit w bit; uszkodzona strona jest odrzucana.
+// 2) Lot kamery przez 12 kawałków i z powrotem: liczba aktywnych kawałków, cząstek w pamięci i czas kroku
+//    nie rosną z przebytą drogą, rośnie tylko liczba odwiedzonych kawałków i bajty na dysku.
+// 3) Kawałki zapisane na dysk i wczytane są takie same jak kawałki, które cały czas zostały w pamięci,
+//    a wynik nie zależy od liczby wątków.
+// 4) Pula do rysowania ma cząstki wszystkich kawałków w pamięci, a krok przepisuje do niej tylko kawałki
+//    policzone albo wczytane - zamrożone kawałki nie są kopiowane.
+// 5) Koszt kroku w porównaniu z pełną symulacją wszystkich kawałków w pamięci.
+// Użycie: particleBench world   (strony w katalogu particleBench_world, usuwanym na końcu)
+namespace WorldBenchmark {
+
+    typedef ChunkedWorld<EmitterSnow> SnowWorld;
+
+    const char* const pageDirectory = "particleBench_world";
+
+    // Każdy świat ma własny podkatalog stron (strony tego samego kawałka mają tę samą nazwę)
+    inline ChunkSettings settings(const std::string& name, size_t pagingBudget = 2) {
+        ChunkSettings s;
+        s.pageDirectory = std::string(pageDirectory) + "/" + name;
+        s.pagingBudget = pagingBudget;
+        return s;
+    }
+
+    inline std::unique_ptr<SnowWorld> makeWorld(const ChunkSettings& s, unsigned threads) {
+        std::unique_ptr<SnowWorld> world(new SnowWorld(s, Scenes::snowChunkEmitter, Scenes::setupSnow));
+        world->setThreadCount(threads);
+        return world;
+    }
+
+    // Kamera leci wzdłuż osi x z prędkością `speed` przez połowę z `steps` kroków, potem wraca tą samą drogą
+    inline ofVec3f cameraAt(int step, int steps, float speed) {
+        const float dt = 1.0f / Scenes::stepRate;
+        const int half = steps / 2;
+        const float distance = float(step <= half ? step : steps - step) * dt * speed;
+        return ofVec3f(distance, 300.0f, 0.0f);
+    }
+
+    inline void step(SnowWorld& world, int s, int steps, float speed) {
+        world.setFocus(cameraAt(s, steps, speed));
+        world.applyForce(Scenes::snowWind());
+        world.update(1.0f / Scenes::stepRate);
+    }
+
+    // Strona zapisana z puli `pool`, potem `damage` psuje plik; odczyt musi zwrócić false i pustą pulę
+    template<class F>
+    inline bool rejected(const ParticlePool& pool, const std::string& path, F damage) {
+        ChunkPage::write(path, pool);
+        damage();
+        ParticlePool back;
+        back.allocate(16);
+        return !ChunkPage::read(path, back, pool.capacity()) && back.size() == 0 && back.capacity() == 0;
+    }
+
+    // Uszkodzony nagłówek albo plik nie może zażądać dowolnej ilości pamięci - strona jest odrzucana przed alokacją
+    inline bool rejectsCorruptPages(const ParticlePool& pool, const std::string& path) {
+        auto patch = [&](std::streamoff offset, uint32_t value) {
+            std::fstream f(path, std::ios::binary | std::ios::in | std::ios::out);
+            f.seekp(offset);
+            f.write(reinterpret_cast<const char*>(&value), sizeof(value));
+        };
+        const bool magic = rejected(pool, path, [&] { patch(0, 0); });
+        const bool version = rejected(pool, path, [&] { patch(offsetof(ChunkPage::Header, version), ChunkPage::version + 1); });
+        const bool capacity = rejected(pool, path, [&] { patch(offsetof(ChunkPage::Header, capacity), 0x7FFFFFFFu); });
+        const bool count = rejected(pool, path, [&] { patch(offsetof(ChunkPage::Header, count), uint32_t(pool.capacity()) + 1); });
+        const bool truncated = rejected(pool, path, [&] { std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1); });
+        const bool ok = magic && version && capacity && count && truncated;
+        std::cout << "corrupt_pages_rejected\t" << ok << "\t(magic " << magic << ", version " << version << ", capacity " << capacity
+                  << ", count " << count << ", truncated " << truncated << ")" << std::endl;
+        return ok;
+    }
+
+    inline bool checkPages() {
+        ParticleSystem<EmitterSet> system(Scenes::christmasEmitters());
+        Scenes::setupChristmas(system);
+        for (int s = 0; s < 360; ++s) {
+            system.applyForce(Scenes::snowWind());
+            system.update(1.0f / Scenes::stepRate);
+        }
+        std::filesystem::create_directories(pageDirectory);
+        const std::string path = std::string(pageDirectory) + "/roundtrip.pchk";
+        const PoolLayout layouts[] = { PoolLayout::Full, PoolLayout::Compact, PoolLayout::CompactHalf };
+        bool ok = true;
+        std::cout << "layout\tparticles\tpage_bytes\tbytes_per_particle\tround_trip_exact" << std::endl;
+        for (PoolLayout layout : layouts) {
+            ParticlePool pool = system.particles;
+            pool.setLayout(layout);
+            const uint64_t bytes = ChunkPage::write(path, pool);
+            ParticlePool back;
+            bool exact = bytes > 0 && ChunkPage::read(path, back, pool.capacity()) && back.layout() == layout
+                      && back.capacity() == pool.capacity() && CompactBenchmark::sameState(pool, back);
+            ok = ok && exact;
+            std::cout << ParticlePool::layoutName(layout) << "\t" << pool.size() << "\t" << bytes << "\t"
+                      << double(bytes) / double(std::max<size_t>(pool.size(), 1)) << "\t" << exact << std::endl;
+        }
+        ok = rejectsCorruptPages(system.particles, path) && ok;
+        std::remove(path.c_str());
+        return ok;
+    }
+
+    // Długi lot; co sekundę wiersz metryk. Zwraca false, jeśli liczba aktywnych kawałków się zmienia
+    // albo kawałków w pamięci jest więcej niż pierścień residentRadius i kolejka stron
+    inline bool flight() {
+        const float speed = 3000.0f;                            //1.5 kawałka na sekundę
+        const int steps = int(2 * 8 * Scenes::stepRate);         //8 s w jedną stronę (12 kawałków), 8 s z powrotem
+        std::unique_ptr<SnowWorld> world = makeWorld(settings("flight"), 1);
+        const ChunkSettings& s = world->getSettings();
+        const size_t ring = size_t(2 * s.residentRadius + 1);
+        const size_t activeChunks = size_t(2 * s.activeRadius + 1) * size_t(2 * s.activeRadius + 1);
+
+        bool ok = true;
+        size_t maxResident = 0, maxParticles = 0, maxQueued = 0;
+        double totalMs = 0, maxMs = 0, firstSecondMs = 0, lastSecondMs = 0;
+        std::cout << std::endl << "t_s\tcamera_chunk\tactive\tstatistical\tfrozen\tpaged\tcreated\tactive_particles"
+                  << "\tresident_particles\tresident_KB\tpaged_KB\tpage_outs\tpage_ins\tupdate_ms_avg\tupdate_ms_max" << std::endl;
+        double secondMs = 0, secondMax = 0;
+        for (int i = 1; i <= steps; ++i) {
+            step(*world, i, steps, speed);
+            const ChunkMetrics m = world->metrics();
+            secondMs += m.updateMs;
+            secondMax = std::max(secondMax, m.updateMs);
+            totalMs += m.updateMs;
+            maxMs = std::max(maxMs, m.updateMs);
+            const size_t resident = m.active + m.statistical + m.frozen;
+            maxResident = std::max(maxResident, resident);
+            maxParticles = std::max(maxParticles, m.residentParticles);
+            maxQueued = std::max(maxQueued, m.queuedPages);
+            ok = ok && m.active == activeChunks && m.queuedPages <= m.created;   //Kawałek w kolejce najwyżej raz
+            if (i % int(Scenes::stepRate) == 0) {
+                const double avg = secondMs / Scenes::stepRate;
+                if (i == int(Scenes::stepRate)) firstSecondMs = avg;
+                lastSecondMs = avg;
+                std::cout << i / int(Scenes::stepRate) << "\t" << int(std::floor(world->getFocus().x / s.size + 0.5f)) << "\t" << m.active
+                          << "\t" << m.statistical << "\t" << m.frozen << "\t" << m.paged << "\t" << m.created << "\t" << m.activeParticles
+                          << "\t" << m.residentParticles << "\t" << m.residentBytes / 1024 << "\t" << m.pagedBytes / 1024
+                          << "\t" << m.pageOuts << "\t" << m.pageIns << "\t" << avg << "\t" << secondMax << std::endl;
+                secondMs = secondMax = 0;
+            }
+        }
+        const bool bounded = maxResident <= ring * ring + 2 * ring;       //Pierścień + kawałki czekające na zapis
+        ok = ok && bounded && world->metrics().pageIns > 0;
+        std::cout << "active_chunks_constant\t" << ok << "\tmax_resident_chunks\t" << maxResident << "\tmax_resident_particles\t" << maxParticles
+                  << "\tmax_queued_pages\t" << maxQueued
+                  << "\tupdate_ms_avg\t" << totalMs / steps << "\tmax\t" << maxMs << "\tfirst_s\t" << firstSecondMs << "\tlast_s\t" << lastSecondMs << std::endl;
+        return ok;
+    }
+
+    // Kawałki po zapisie i odczycie == kawałki trzymane w pamięci (pagingBudget 0 - nic nie idzie na dysk)
+    // oraz ten sam wynik dla jednego i wszystkich wątków
+    inline bool exactness() {
+        const float speed = 3000.0f;
+        const int steps = int(2 * 3 * Scenes::stepRate);         //4.5 kawałka w jedną stronę i z powrotem
+        std::unique_ptr<SnowWorld> paged = makeWorld(settings("paged"), 1);
+        std::unique_ptr<SnowWorld> kept = makeWorld(settings("kept", 0), 1);
+        std::unique_ptr<SnowWorld> threaded = makeWorld(settings("threaded"), 0);
+        for (int i = 1; i <= steps; ++i) {
+            step(*paged, i, steps, speed);
+            step(*kept, i, steps, speed);
+            step(*threaded, i, steps, speed);
+        }
+        bool lossless = paged->metrics().pageIns > 0;
+        size_t compared = 0;
+        const int r = paged->getSettings().residentRadius;
+        for (int z = -r; z <= r; ++z) {
+            for (int x = -r; x <= r; ++x) {
+                const ParticlePool* a = paged->chunkParticles(x, z);
+                const ParticlePool* b = kept->chunkParticles(x, z);
+                if (!a || !b) continue;
+                lossless = lossless && ParallelBenchmark::samePool(*a, *b);
+                ++compared;
+            }
+        }
+        const bool sameThreads = ParallelBenchmark::samePool(paged->particles, threaded->particles);
+        std::cout << std::endl << "check\tresult" << std::endl;
+        std::cout << "paged_chunks_equal_kept_chunks\t" << lossless << "\t(" << compared << " kawalkow, wczytane strony: "
+                  << paged->metrics().pageIns << ")" << std::endl;
+        std::cout << "same_for_1_and_all_threads\t" << sameThreads << std::endl;
+        return lossless && compared > 0 && sameThreads;
+    }
+
+    // Pula do rysowania == cząstki kawałków w pamięci (w dowolnej kolejności)
+    inline bool drawnMatchesChunks(SnowWorld& world) {
+        typedef std::tuple<float, float, float, float, uint32_t> Key;
+        auto rgba = [](const ofColor& c) { return uint32_t(c.r) << 24 | uint32_t(c.g) << 16 | uint32_t(c.b) << 8 | c.a; };
+        std::vector<Key> drawn, chunks;
+        const ParticlePool& d = world.particles;
+        for (size_t i = 0; i < d.size(); ++i) drawn.emplace_back(d.x[i], d.y[i], d.z[i], d.age[i], rgba(d.color[i]));
+        world.forEachResident([&](SnowWorld::System& system) {
+            const ParticlePool& p = system.particles;
+            for (size_t i = 0; i < p.size(); ++i) chunks.emplace_back(p.x[i], p.y[i], p.z[i], p.age[i], rgba(p.colorAt(i)));
+        });
+        std::sort(drawn.begin(), drawn.end());
+        std::sort(chunks.begin(), chunks.end());
+        return drawn == chunks;
+    }
+
+    // Lot przez 3 kawałki, potem kamera stoi: zamrożone kawałki za nią mają cząstki, ale krok ich nie przepisuje
+    inline bool drawing() {
+        const float speed = 3000.0f;
+        const int steps = int(2 * Scenes::stepRate);
+        std::unique_ptr<SnowWorld> world = makeWorld(settings("drawing"), 1);
+        const ChunkSettings& s = world->getSettings();
+        bool sized = true, frozenSkipped = true;
+        size_t copied = 0, resident = 0, frozen = 0;
+        for (int i = 1; i <= 2 * steps; ++i) {
+            step(*world, std::min(i, steps), 2 * steps, speed);
+            const ChunkMetrics m = world->metrics();
+            sized = sized && world->particles.size() == m.residentParticles;
+            if (i <= steps) continue;
+            const int fx = int(std::floor(world->getFocus().x / s.size + 0.5f));
+            size_t frozenNow = 0;
+            for (int z = -s.residentRadius; z <= s.residentRadius; ++z) {
+                for (int x = fx - s.residentRadius; x <= fx + s.residentRadius; ++x) {
+                    if (std::max(std::abs(x - fx), std::abs(z)) != s.residentRadius) continue;
+                    const ParticlePool* p = world->chunkParticles(x, z);
+                    if (p) frozenNow += p->size();
+                }
+            }
+            frozenSkipped = frozenSkipped && frozenNow > 0 && m.copiedParticles + frozenNow <= m.residentParticles;
+            copied += m.copiedParticles;
+            resident += m.residentParticles;
+            frozen += frozenNow;
+        }
+        const bool same = drawnMatchesChunks(*world);
+        std::cout << std::endl << "check\tresult" << std::endl;
+        std::cout << "drawn_pool_equals_resident_chunks\t" << (same && sized) << std::endl;
+        std::cout << "frozen_chunks_not_copied\t" << frozenSkipped << "\t(na krok: skopiowane " << copied / steps << ", w pamieci "
+                  << resident / steps << ", zamrozone " << frozen / steps << ")" << std::endl;
+        return same && sized && frozenSkipped;
+    }
+
+    // Ten sam lot z pełną symulacją wszystkich kawałków w pamięci (activeRadius = residentRadius)
+    inline void compareFull() {
+        const float speed = 3000.0f;
+        const int steps = int(2 * Scenes::stepRate);
+        ChunkSettings full = settings("full");
+        full.activeRadius = full.statisticalRadius = full.residentRadius;
+        double ms[2] = { 0, 0 };
+        size_t particles[2] = { 0, 0 };
+        ChunkSettings variants[2] = { settings("chunked"), full };
+        for (int v = 0; v < 2; ++v) {
+            std::unique_ptr<SnowWorld> world = makeWorld(variants[v], 1);
+            for (int i = 1; i <= steps; ++i) {
+                step(*world, i, steps, speed);
+                if (i > int(Scenes::stepRate)) {                //Pierwsza sekunda - wypełnianie kawałków
+                    ms[v] += world->metrics().updateMs;
+                    particles[v] = std::max(particles[v], world->metrics().activeParticles);
+                }
+            }
+            ms[v] /= steps - int(Scenes::stepRate);
+        }
+        std::cout << std::endl << "simulation\tmax_active_particles\tupdate_ms" << std::endl;
+        std::cout << "chunked (active 3x3, statistical 5x5, frozen 7x7)\t" << particles[0] << "\t" << ms[0] << std::endl;
+        std::cout << "full (7x7 active)\t" << particles[1] << "\t" << ms[1] << "\t(" << ms[1] / ms[0] << "x)" << std::endl;
+    }
+
+    inline bool run() {
+        bool ok = checkPages();
+        ok = flight() && ok;
+        ok = exactness() && ok;
+        ok = drawing() && ok;
+        compareFull();
+        std::error_code ec;
+        std::filesystem::remove_all(pageDirectory, ec);
+        return ok;
+    }
+}
@@ -0,0 +1,112 @@
+#include "ofMain.h"
+#include "ReapBenchmark.h"
+#include "EmitBenchmark.h"
+#include "ParallelBenchmark.h"
+#include "SimdBenchmark.h"
+#include "HeadlessBenchmark.h"
+#include "ColliderBenchmark.h"
+#include "NeighbourBenchmark.h"
+#include "SchedulerBenchmark.h"
+#include "RandomBenchmark.h"
+#include "ForceBenchmark.h"
+#include "CullingBenchmark.h"
+#include "RecordBenchmark.h"
+#include "ProfileBenchmark.h"
+#include "CcdBenchmark.h"
+#include "SceneBenchmark.h"
+#include "CompactBenchmark.h"
+#include "WorldBenchmark.h"
+#include "GroundBenchmark.h"
+
+//========================================================================
+// Benchmarki systemu cząsteczek - bez okna i bez OpenGL
+// Użycie: particleBench <nazwa>     (domyślnie: reap)
+//   reap      - koszt usuwania martwych cząstek na klatkę
+//   emit      - alokacje w stanie ustalonym (kod wyjścia 1, jeśli klatka alokuje)
+//   parallel  - czas aktualizacji dla różnej liczby wątków (kod wyjścia 1, jeśli wynik różni się od szeregowego)
+//   headless  - symulacja obu scen ze stałym dt, wyniki jako JSON Lines (opcje w HeadlessBenchmark.h)
+//   simd      - cząstki/s dla każdego kernela i zestawu instrukcji (kod wyjścia 1, jeśli wynik różni się od skalarnego)
+//   colliders - koszt kolizji na klatkę dla 1..10 000 kul (kod wyjścia 1, jeśli siatka daje inny wynik niż przegląd)
+//   ccd       - ciągła kolizja z kulą: przypadki przelatywania przy dużym dt (kod wyjścia 1, jeśli cząstka przeleci przez kulę)
+//   neighbours [wątki] - budowa haszowanej siatki i oddziaływania cząstka-cząstka dla 100 tys. cząstek (kod wyjścia 1, jeśli siatka gubi sąsiadów)
+//   culling   - odrzucanie poza kadrem i koszyki LOD dla 1 mln płatków z kilku widoków kamery
+//   record    - nagrywanie i odtwarzanie: bajty na cząstkę, koszt kodowania (kod wyjścia 1, jeśli odtworzenie odbiega od symulacji)
+//   compact   - układy puli Full/Compact/CompactHalf: bajty i czas na cząstkę (kod wyjścia 1, jeśli Compact odbiega od Full)
+//   world     - świat z kawałków (ChunkedWorld): koszt kroku i pamięć przy locie kamery, strony na dysku (kod wyjścia 1 przy błędzie)
+//   ground    - śnieg osiadający na ziemi (GroundAccumulation): żywe cząstki, pamięć i koszt (kod wyjścia 1 przy błędzie)
+//   scene [katalog] - pliki scen: zgodność z Scenes.h i przeładowanie w trakcie działania (kod wyjścia 1 przy błędzie)
+//   profile [plik] - narzut FrameProfiler, p50/p99 etapów aktualizacji i ślad Chrome (JSON)
+//   forces    - koszt pól sił na cząstkę: każde pole osobno i wszystkie w jednym przejściu
+//   random    - koszt losowania przy emisji (kod wyjścia 1, jeśli ten sam seed nie daje tych samych cząstek)
+//   scheduler - stały krok symulacji (kod wyjścia 1, jeśli wynik zależy od fps albo limit nadrabiania nie działa)
+int main(int argc, char* argv[]) {
+	std::string name = argc > 1 ? argv[1] : "reap";
+
+	if (name == "reap") {
+		ReapBenchmark::run();					//Koszt usuwania martwych cząstek na klatkę
+	} else if (name == "emit") {
+		if (!EmitBenchmark::run()) {			//Emisja i aktualizacja nie mogą alokować
+			return 1;
+		}
+	} else if (name == "parallel") {
+		if (!ParallelBenchmark::run()) {		//Wynik równoległy musi być identyczny z szeregowym
+			return 1;
+		}
+	} else if (name == "simd") {
+		if (!SimdBenchmark::run()) {			//Wersje SSE/AVX2 muszą liczyć to samo co skalarna
+			return 1;
+		}
+	} else if (name == "headless") {
+		HeadlessBenchmark::run(argc, argv, 2);	//Opcje klucz=wartość po nazwie benchmarku
+	} else if (name == "colliders") {
+		if (!ColliderBenchmark::run()) {		//Siatka musi dawać ten sam wynik co sprawdzenie wszystkich kul
+			return 1;
+		}
+	} else if (name == "ccd") {
+		if (!CcdBenchmark::run()) {				//Żadna cząstka nie może przelecieć przez kulę
+			return 1;
+		}
+	} else if (name == "neighbours") {
+		if (!NeighbourBenchmark::run(argc > 2 ? unsigned(std::atoi(argv[2])) : 0)) {	//Siatka daje tych samych sąsiadów co przegląd par
+			return 1;
+		}
+	} else if (name == "scheduler") {
+		if (!SchedulerBenchmark::run()) {		//Ten sam stan przy każdym fps i ograniczone nadrabianie
+			return 1;
+		}
+	} else if (name == "random") {
+		if (!RandomBenchmark::run()) {			//Emisja musi być powtarzalna
+			return 1;
+		}
+	} else if (name == "forces") {
+		ForceBenchmark::run();
+	} else if (name == "culling") {
+		CullingBenchmark::run();
+	} else if (name == "profile") {
+		ProfileBenchmark::run(argc > 2 ? argv[2] : "particleBench_trace.json");
+	} else if (name == "record") {
+		if (!RecordBenchmark::run()) {			//Odtworzenie musi zgadzać się z nagraną symulacją
+			return 1;
+		}
+	} else if (name == "compact") {
+		if (!CompactBenchmark::run()) {			//Compact jak Full bit w bit, CompactHalf poniżej 24 B na cząstkę
+			return 1;
+		}
+	} else if (name == "world") {
+		if (!WorldBenchmark::run()) {			//Stała liczba aktywnych kawałków, strony bez strat
+			return 1;
+		}
+	} else if (name == "ground") {
+		if (!GroundBenchmark::run()) {			//Śnieg zachowany, nic pod ziemią, wynik jak dla jednego wątku
+			return 1;
+		}
+	} else if (name == "scene") {
+		if (!SceneBenchmark::run(argc > 2 ? argv[2] : ".")) {	//Pliki scen jak Scenes.h, zmiany bez nowej puli
+			return 1;
+		}
+	} else {
+		std::cerr << "Nieznany benchmark: " << name << std::endl;
+		return 1;
+	}
+	return 0;
+}
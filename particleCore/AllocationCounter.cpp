@@ -0,0 +1,51 @@
+#include "AllocationCounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+    std::atomic<uint64_t> allocationCount(0);
+    std::atomic<uint64_t> deallocationCount(0);
+    std::atomic<uint64_t> allocatedBytes(0);
+
+    void* countedAlloc(std::size_t size) {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+        return std::malloc(size == 0 ? 1 : size);
+    }
+
+    void countedFree(void* ptr) {
+        if (ptr) {
+            deallocationCount.fetch_add(1, std::memory_order_relaxed);
+            std::free(ptr);
+        }
+    }
+}
+
+uint64_t AllocationCounter::allocations() { return allocationCount.load(std::memory_order_relaxed); }
+uint64_t AllocationCounter::deallocations() { return deallocationCount.load(std::memory_order_relaxed); }
+uint64_t AllocationCounter::bytesAllocated() { return allocatedBytes.load(std::memory_order_relaxed); }
+
+// Globalne operatory new/delete (wersje z wyrównaniem - align_val_t - nie są liczone)
+void* operator new(std::size_t size) {
+    void* ptr = countedAlloc(size);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[](std::size_t size) {
+    void* ptr = countedAlloc(size);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size); }
+
+void operator delete(void* ptr) noexcept { countedFree(ptr); }
+void operator delete[](void* ptr) noexcept { countedFree(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { countedFree(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { countedFree(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { countedFree(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { countedFree(ptr); }
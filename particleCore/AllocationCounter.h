@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+
+// Liczniki alokacji na stercie
+// AllocationCounter.cpp podmienia globalne operator new/delete, więc liczone jest każde
+// `new`, std::vector::push_back z realokacją itd. w całym programie. Koszt to jeden
+// atomowy inkrement na alokację. Żeby sprawdzić, czy klatka nie alokuje, wystarczy
+// porównać allocations() przed i po.
+namespace AllocationCounter {
+    uint64_t allocations();                 //Liczba alokacji od startu programu
+    uint64_t deallocations();               //Liczba zwolnień od startu programu
+    uint64_t bytesAllocated();              //Suma zaalokowanych bajtów od startu programu
+}
@@ -0,0 +1,639 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ParticleSystem.h"
+#include "JobSystem.h"
+#include "FrameProfiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Stan kawałka świata - zależy od odległości (w kawałkach) od kawałka obserwatora
+enum class ChunkState {
+    Active,                                 //Pełna symulacja co krok (update)
+    Statistical,                            //Co statisticalInterval kroków nadrabia czas krokami bez oddziaływań (updateCoarse)
+    Frozen,                                 //W pamięci, bez symulacji - zaległy czas nadrabiany przy powrocie
+    Paged                                   //Cząstki zapisane na dysk (albo usunięte), pula zwolniona
+};
+
+struct ChunkSettings {
+    float size;                             //Bok kawałka w osiach x i z
+    int activeRadius;                       //Promienie (max z |dx|, |dz| w kawałkach od kawałka obserwatora)
+    int statisticalRadius;
+    int residentRadius;                     //Dalej kawałki idą na dysk
+    int statisticalInterval;                //Co ile kroków kawałek statystyczny nadrabia czas (przesunięte między kawałkami)
+    size_t pagingBudget;                    //Najwięcej zapisów/odczytów stron na krok - reszta czeka w kolejce
+    std::string pageDirectory;              //Katalog stron; pusty - odległe kawałki są usuwane i przy powrocie tworzone od nowa
+
+    ChunkSettings() : size(2000.0f), activeRadius(1), statisticalRadius(2), residentRadius(3),
+                      statisticalInterval(8), pagingBudget(2) {}
+};
+
+struct ChunkMetrics {
+    size_t active, statistical, frozen, paged;  //Liczba kawałków w każdym stanie
+    size_t created;                         //Kawałki utworzone od początku (odwiedzony obszar)
+    size_t dropped;                         //Kawałki usunięte bez katalogu stron
+    size_t queuedPages;                     //Kawałki czekające w kolejce stronicowania (każdy najwyżej raz)
+    size_t activeParticles;                 //Cząstki z pełną symulacją
+    size_t residentParticles;               //Cząstki wszystkich kawałków w pamięci
+    uint64_t residentBytes;                 //Pamięć pul kawałków w pamięci (pojemność)
+    uint64_t pagedBytes;                    //Dane kawałków na dysku
+    uint64_t pageOuts, pageIns;             //Zapisane i wczytane strony od początku
+    size_t coarseSteps;                     //Kroki updateCoarse w ostatnim update
+    size_t copiedParticles;                 //Cząstki przepisane do puli do rysowania w ostatnim update (tylko zmienione kawałki)
+    double updateMs;                        //Czas ostatniego update (stronicowanie + symulacja + zebranie stanu)
+    double pagingMs;                        //W tym zapis i odczyt stron
+
+    ChunkMetrics() : active(0), statistical(0), frozen(0), paged(0), created(0), dropped(0), queuedPages(0), activeParticles(0),
+                     residentParticles(0), residentBytes(0), pagedBytes(0), pageOuts(0), pageIns(0), coarseSteps(0), copiedParticles(0),
+                     updateMs(0), pagingMs(0) {}
+};
+
+// Strona kawałka na dysku: nagłówek i tablice puli w jej układzie (bez konwersji - odczyt daje te same bity)
+//   "PCHK", wersja, układ, liczba cząstek, liczba rekordów emiterów, pojemność puli
+//   x, y, z, wiek; prędkość (float albo half); czas życia, odwrotność masy, kolor, flagi (Full) albo numery i rekordy emiterów
+namespace ChunkPage {
+
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint32_t layout;
+        uint32_t count;
+        uint32_t records;
+        uint32_t capacity;
+    };
+
+    static_assert(sizeof(Header) == 24, "Układ nagłówka strony");
+
+    const uint32_t version = 2;             //2: flagi cząstek (Full) i w rekordach emiterów
+
+    template<class T>
+    void writeArray(std::ofstream& out, const std::vector<T>& v) {
+        out.write(reinterpret_cast<const char*>(v.data()), std::streamsize(v.size() * sizeof(T)));
+    }
+
+    template<class T>
+    void readArray(std::ifstream& in, std::vector<T>& v) {
+        in.read(reinterpret_cast<char*>(v.data()), std::streamsize(v.size() * sizeof(T)));
+    }
+
+    // Zwraca liczbę zapisanych bajtów (0 przy błędzie)
+    inline uint64_t write(const std::string& path, const ParticlePool& p) {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out) return 0;
+        Header header = { { 'P', 'C', 'H', 'K' }, version, uint32_t(p.layout()), uint32_t(p.size()),
+                          uint32_t(p.emitterRecords.size()), uint32_t(p.capacity()) };
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        writeArray(out, p.x); writeArray(out, p.y); writeArray(out, p.z);
+        writeArray(out, p.age);
+        if (p.halfVelocity()) {
+            writeArray(out, p.hvx); writeArray(out, p.hvy); writeArray(out, p.hvz);
+        } else {
+            writeArray(out, p.vx); writeArray(out, p.vy); writeArray(out, p.vz);
+        }
+        if (p.compact()) {
+            writeArray(out, p.emitterIndex);
+            writeArray(out, p.emitterRecords);
+        } else {
+            writeArray(out, p.lifetime); writeArray(out, p.invMass);
+            writeArray(out, p.color); writeArray(out, p.flags);
+        }
+        const uint64_t bytes = uint64_t(out.tellp());
+        return out ? bytes : 0;
+    }
+
+    // Rozmiar pliku strony opisanej nagłówkiem (ten sam, który zapisuje write)
+    inline uint64_t pageSize(const Header& header) {
+        const PoolLayout layout = PoolLayout(header.layout);
+        uint64_t bytes = sizeof(Header) + uint64_t(header.count) * ParticlePool::bytesPerParticle(layout);
+        if (layout != PoolLayout::Full) bytes += uint64_t(header.records) * sizeof(EmitterRecord);
+        return bytes;
+    }
+
+    // Wczytuje stronę do nowej puli (układ i pojemność jak przy zapisie); false przy błędzie albo uszkodzonym pliku.
+    // Nagłówek jest sprawdzany przed alokacją: znacznik i wersja, liczba <= pojemność <= maxCapacity
+    // i rozmiar pliku zgodny z liczbą cząstek - uszkodzony plik nie może zażądać dowolnej ilości pamięci.
+    inline bool read(const std::string& path, ParticlePool& p, size_t maxCapacity) {
+        p = ParticlePool();
+        std::error_code ec;
+        const uint64_t fileSize = std::filesystem::file_size(path, ec);
+        std::ifstream in(path, std::ios::binary);
+        Header header;
+        if (ec || !in.read(reinterpret_cast<char*>(&header), sizeof(header))
+            || std::string(header.magic, 4) != "PCHK" || header.version != version || header.layout > uint32_t(PoolLayout::CompactHalf)
+            || header.records > ParticlePool::maxRecords || header.count > header.capacity || header.capacity > maxCapacity
+            || fileSize != pageSize(header)) {
+            return false;
+        }
+        p.setLayout(PoolLayout(header.layout));
+        p.allocate(header.capacity);
+        p.resize(header.count);
+        readArray(in, p.x); readArray(in, p.y); readArray(in, p.z);
+        readArray(in, p.age);
+        if (p.halfVelocity()) {
+            readArray(in, p.hvx); readArray(in, p.hvy); readArray(in, p.hvz);
+        } else {
+            readArray(in, p.vx); readArray(in, p.vy); readArray(in, p.vz);
+        }
+        if (p.compact()) {
+            p.emitterRecords.resize(header.records);
+            readArray(in, p.emitterIndex);
+            readArray(in, p.emitterRecords);
+            for (uint8_t r : p.emitterIndex) {
+                if (r >= header.records) {
+                    p = ParticlePool();
+                    return false;
+                }
+            }
+        } else {
+            readArray(in, p.lifetime); readArray(in, p.invMass);
+            readArray(in, p.color); readArray(in, p.flags);
+        }
+        if (!in) p = ParticlePool();
+        return bool(in);
+    }
+}
+
+// Klasa ChunkedWorld - Świat podzielony na kwadratowe kawałki (w osiach x i z), każdy z własnym ParticleSystem
+// Kawałek (0, 0) to kwadrat +- size / 2 wokół początku układu (przy size 2000 - dawne pudełko EmitterSnow).
+// Koszt kroku zależy od liczby kawałków wokół obserwatora, nie od odwiedzonego obszaru:
+//  - Active (promień activeRadius) - pełna symulacja co krok, z oddziaływaniami między cząstkami,
+//  - Statistical (statisticalRadius) - co statisticalInterval kroków kilka kroków updateCoarse (siły i ruch, bez sąsiadów),
+//  - Frozen (residentRadius) - tylko w pamięci; zaległy czas nadrabiany krokami updateCoarse przy powrocie,
+//  - Paged - dalej; pula zapisana na dysk (ChunkPage) i zwolniona, wczytywana, gdy kawałek znów jest blisko.
+// Zaległość dłuższa niż czas życia cząstek zaczyna kawałek od stanu ustalonego (starsze cząstki i tak by umarły) -
+// nowy kawałek od razu ma padający śnieg. Cząstka należy do kawałka, który ją wyemitował, nawet gdy wiatr
+// wyniesie ją za jego granicę; oddziaływania działają w obrębie kawałka.
+// Kawałki są liczone równolegle (po jednym zadaniu na kawałek) i niezależnie od siebie, więc wynik nie zależy
+// od liczby wątków. Każdy kawałek ma własny strumień losowy (ziarno + współrzędne kawałka).
+// Pula do rysowania zmienia się tylko o kawałki policzone albo wczytane w tym kroku - zamrożone kawałki
+// nie są do niej kopiowane co krok (kolejność cząstek w niej nie odpowiada kolejności kawałków).
+// Interfejs jak ParticleSystem (particles, applyForce, update, draw), więc działa z FixedStepScheduler.
+template<class EmitterType>
+class ChunkedWorld {
+public:
+    typedef ParticleSystem<EmitterType> System;
+    typedef std::function<EmitterType(const ofVec3f& center, float size, uint64_t stream)> EmitterFactory;
+    typedef std::function<void(System&)> SystemSetup;
+
+    ParticlePool particles;                     //Żywe cząstki wszystkich kawałków w pamięci (Full) - stan do rysowania
+    float particleRadius;                       //Promień rysowanej cząstki
+    mutable ParticleRenderer renderer;
+
+    // Fabryka emitera dostaje środek kawałka (y = 0), jego bok i numer strumienia losowego; setup ustawia nowy system
+    ChunkedWorld(const ChunkSettings& s, EmitterFactory makeEmitter, SystemSetup setup = SystemSetup())
+        : particleRadius(3.0f), settings(s), makeEmitter(makeEmitter), setup(setup), focus(0, 0, 0),
+          focusX(0), focusZ(0), placed(false), time(0), stepIndex(0), drawIndex(0), pendingForce(0, 0, 0) {
+        settings.statisticalInterval = std::max(1, settings.statisticalInterval);
+        settings.statisticalRadius = std::max(settings.activeRadius, settings.statisticalRadius);
+        settings.residentRadius = std::max(settings.statisticalRadius, settings.residentRadius);
+    }
+
+    ~ChunkedWorld() {                           //Strony są pamięcią podręczną tego świata - usuwane razem z nim
+        for (auto& entry : chunks) {
+            if (entry.second->state == ChunkState::Paged && !settings.pageDirectory.empty()) {
+                std::remove(pagePath(*entry.second).c_str());
+            }
+        }
+    }
+
+    ChunkedWorld(const ChunkedWorld&) = delete;
+    ChunkedWorld& operator=(const ChunkedWorld&) = delete;
+
+    static const char* stateName(ChunkState s) {
+        switch (s) {
+            case ChunkState::Active: return "Active";
+            case ChunkState::Statistical: return "Statistical";
+            case ChunkState::Frozen: return "Frozen";
+            case ChunkState::Paged: return "Paged";
+        }
+        return "";
+    }
+
+    const ChunkSettings& getSettings() const { return settings; }
+
+    // Punkt obserwatora (kamera) - wokół jego kawałka kawałki są aktywne; zmiana kawałka przestawia stany w update()
+    // Można wołać z wątku głównego, gdy update() liczy FixedStepScheduler (jak setForce)
+    void setFocus(const ofVec3f& p) {
+        std::lock_guard<std::mutex> lock(focusMutex);
+        focus = p;
+    }
+
+    ofVec3f getFocus() const {
+        std::lock_guard<std::mutex> lock(focusMutex);
+        return focus;
+    }
+
+    // Liczba wątków (łącznie z głównym) liczących kawałki; 1 = szeregowo, 0 = wszystkie rdzenie
+    void setThreadCount(unsigned threads) {
+        if (threads == 1) {
+            jobs.reset();
+        } else {
+            jobs.reset(new JobSystem(threads));
+        }
+    }
+
+    unsigned threadCount() const { return jobs ? jobs->threadCount() : 1; }
+
+    // Siła dla kawałków liczonych w tym kroku (także przy nadrabianiu), skalowana przez dt jak w ParticleSystem
+    void applyForce(const ofVec3f& force) {
+        pendingForce += force;
+    }
+
+    void update(float dt) {
+        typedef std::chrono::steady_clock Clock;
+        const Clock::time_point start = Clock::now();
+        time += dt;
+        const ofVec3f force = pendingForce;
+        pendingForce.set(0, 0, 0);
+
+        const ofVec3f eye = getFocus();
+        const int x = chunkIndex(eye.x), z = chunkIndex(eye.z);
+        if (!placed || x != focusX || z != focusZ) {
+            focusX = x;
+            focusZ = z;
+            placed = true;
+            retier();
+        }
+        const Clock::time_point pagingStart = Clock::now();
+        processPaging();
+        worldMetrics.pagingMs = std::chrono::duration<double, std::milli>(Clock::now() - pagingStart).count();
+
+        work.clear();
+        for (Chunk* c : resident) {
+            if (c->state == ChunkState::Active
+                || (c->state == ChunkState::Statistical && (stepIndex + c->slot) % uint64_t(settings.statisticalInterval) == 0)) {
+                work.push_back(c);
+            }
+        }
+        const float coarseDt = dt * float(settings.statisticalInterval);
+        auto kernel = [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                advance(*work[i], dt, coarseDt, force);
+            }
+        };
+        if (jobs) {
+            jobs->parallelFor(work.size(), 1, kernel);  //Jeden kawałek na zadanie
+        } else {
+            kernel(0, work.size());
+        }
+        ++stepIndex;
+
+        gather();
+        worldMetrics.coarseSteps = 0;
+        for (Chunk* c : work) worldMetrics.coarseSteps += c->coarseSteps;
+        worldMetrics.updateMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        std::lock_guard<std::mutex> lock(metricsMutex);
+        publishedMetrics = worldMetrics;
+    }
+
+    void draw() const {
+        draw(particles, 0.0f);
+    }
+
+    void draw(const ParticlePool& state, float rewind) const {
+        ProfileScope scope(ProfileStage::Draw, ++drawIndex);
+        renderer.draw(state, particleRadius, rewind);
+    }
+
+    // Metryki po ostatnim update (kopia - można czytać z wątku głównego w trakcie symulacji)
+    ChunkMetrics metrics() const {
+        std::lock_guard<std::mutex> lock(metricsMutex);
+        return publishedMetrics;
+    }
+
+    // Pula kawałka (nullptr - kawałek nie istnieje albo jest na dysku) - do porównań w benchmarku
+    const ParticlePool* chunkParticles(int x, int z) const {
+        auto it = chunks.find(key(x, z));
+        if (it == chunks.end() || it->second->state == ChunkState::Paged) return nullptr;
+        return &it->second->system->particles;
+    }
+
+    // Wywołuje fn(System&) dla każdego kawałka w pamięci (np. zmiana trybu oddziaływań)
+    template<class F>
+    void forEachResident(F fn) {
+        for (Chunk* c : resident) {
+            fn(*c->system);
+            c->changed = true;                  //fn może zmienić cząstki - do przepisania w następnym update
+        }
+    }
+
+private:
+    struct Chunk {
+        int x, z;
+        ChunkState state;
+        std::unique_ptr<System> system;
+        double time;                            //Czas świata, do którego kawałek jest policzony
+        uint32_t slot;                          //Przesunięcie kroków statystycznych (nie wszystkie w tym samym kroku)
+        size_t capacity;                        //Pojemność i układ puli zwolnionej przy zapisie na dysk
+        PoolLayout layout;
+        uint64_t pageBytes;                     //Rozmiar strony na dysku (Paged)
+        size_t coarseSteps;                     //Kroki updateCoarse w ostatnim kroku świata
+        bool queued;                            //Już czeka w pagingQueue - bez powtórnego wpisu
+        bool changed;                           //Cząstki zmienione od ostatniego gather (policzony, wczytany, nowy)
+        std::vector<uint32_t> drawn;            //Indeksy cząstek kawałka w `particles`
+    };
+
+    ChunkSettings settings;
+    EmitterFactory makeEmitter;
+    SystemSetup setup;
+    mutable std::mutex focusMutex;
+    ofVec3f focus;
+    int focusX, focusZ;                         //Kawałek obserwatora
+    bool placed;
+    double time;                                //Czas świata w sekundach
+    uint64_t stepIndex;
+    mutable uint32_t drawIndex;
+    ofVec3f pendingForce;
+    std::unique_ptr<JobSystem> jobs;
+
+    std::map<uint64_t, std::unique_ptr<Chunk>> chunks;     //Wszystkie znane kawałki (stała kolejność - powtarzalny wynik)
+    std::vector<Chunk*> resident;               //Kawałki w pamięci w kolejności kluczy
+    std::vector<Chunk*> work;                   //Kawałki liczone w bieżącym kroku
+    std::vector<Chunk*> drawnOwner;             //Dla każdej cząstki `particles`: jej kawałek i pozycja w jego `drawn`
+    std::vector<uint32_t> drawnSlot;
+    std::deque<uint64_t> pagingQueue;           //Kawałki do zapisania lub wczytania (w granicach pagingBudget)
+    ChunkMetrics worldMetrics;                  //Liczone w update()
+    mutable std::mutex metricsMutex;
+    ChunkMetrics publishedMetrics;              //Kopia dla metrics()
+
+    static uint64_t key(int x, int z) { return (uint64_t(uint32_t(x)) << 32) | uint32_t(z); }
+
+    int chunkIndex(float v) const { return int(std::floor(v / settings.size + 0.5f)); }
+
+    ofVec3f chunkCenter(int x, int z) const {
+        return ofVec3f(float(x) * settings.size, 0, float(z) * settings.size);
+    }
+
+    std::string pagePath(const Chunk& c) const {
+        return settings.pageDirectory + "/chunk_" + std::to_string(c.x) + "_" + std::to_string(c.z) + ".pchk";
+    }
+
+    ChunkState desiredState(const Chunk& c) const {
+        const int d = std::max(std::abs(c.x - focusX), std::abs(c.z - focusZ));
+        if (d <= settings.activeRadius) return ChunkState::Active;
+        if (d <= settings.statisticalRadius) return ChunkState::Statistical;
+        if (d <= settings.residentRadius) return ChunkState::Frozen;
+        return ChunkState::Paged;
+    }
+
+    // Nowy kawałek zaczyna zaległością równą czasowi życia - pierwsze nadrabianie daje stan ustalony
+    Chunk& create(int x, int z) {
+        std::unique_ptr<Chunk> c(new Chunk());
+        c->x = x;
+        c->z = z;
+        c->state = ChunkState::Frozen;
+        c->system.reset(new System(makeEmitter(chunkCenter(x, z), settings.size, key(x, z))));
+        if (setup) setup(*c->system);
+        c->time = time - c->system->emitter.maxLifetime();
+        c->slot = uint32_t((key(x, z) * 0x9E3779B97F4A7C15ull) >> 40) % uint32_t(settings.statisticalInterval);
+        c->capacity = c->system->particles.capacity();
+        c->layout = c->system->particles.layout();
+        c->pageBytes = 0;
+        c->coarseSteps = 0;
+        c->queued = false;
+        c->changed = true;
+        Chunk& ref = *c;
+        chunks[key(x, z)] = std::move(c);
+        ++worldMetrics.created;
+        return ref;
+    }
+
+    // Po zmianie kawałka obserwatora: brakujące kawałki w promieniu residentRadius, nowe stany, kolejka stron.
+    // Kawałek potrzebny do symulacji jest wczytywany od razu; zamrożone i odległe czekają na budżet stronicowania.
+    void retier() {
+        const int r = settings.residentRadius;
+        for (int z = focusZ - r; z <= focusZ + r; ++z) {
+            for (int x = focusX - r; x <= focusX + r; ++x) {
+                if (chunks.find(key(x, z)) == chunks.end()) create(x, z);
+            }
+        }
+        for (auto& entry : chunks) {
+            Chunk& c = *entry.second;
+            const ChunkState desired = desiredState(c);
+            if (desired == ChunkState::Paged) {
+                if (c.state != ChunkState::Paged) {
+                    c.state = ChunkState::Frozen;
+                    enqueue(c, entry.first);
+                }
+            } else if (c.state == ChunkState::Paged) {
+                if (desired == ChunkState::Frozen) {
+                    enqueue(c, entry.first);
+                } else {
+                    pageIn(c, desired);
+                }
+            } else {
+                c.state = desired;
+            }
+        }
+        rebuildResident();
+    }
+
+    // Kawałek trafia do kolejki raz - przy kolejnych zmianach obserwatora processPaging i tak sprawdzi jego stan
+    void enqueue(Chunk& c, uint64_t k) {
+        if (c.queued) return;
+        c.queued = true;
+        pagingQueue.push_back(k);
+    }
+
+    void processPaging() {
+        size_t done = 0;
+        while (done < settings.pagingBudget && !pagingQueue.empty()) {
+            const uint64_t k = pagingQueue.front();
+            pagingQueue.pop_front();
+            auto it = chunks.find(k);
+            if (it == chunks.end()) continue;
+            Chunk& c = *it->second;
+            c.queued = false;
+            const ChunkState desired = desiredState(c);
+            if (desired == ChunkState::Paged && c.state != ChunkState::Paged) {
+                pageOut(c);
+                ++done;
+            } else if (desired == ChunkState::Frozen && c.state == ChunkState::Paged) {
+                pageIn(c, desired);
+                ++done;
+            }
+        }
+        if (done > 0) rebuildResident();
+    }
+
+    // Zapis puli na dysk i zwolnienie pamięci; bez katalogu stron kawałek jest usuwany
+    void pageOut(Chunk& c) {
+        if (settings.pageDirectory.empty()) {
+            ++worldMetrics.dropped;
+            hide(c);
+            chunks.erase(key(c.x, c.z));
+            return;
+        }
+        std::error_code ec;
+        std::filesystem::create_directories(settings.pageDirectory, ec);
+        const uint64_t bytes = ChunkPage::write(pagePath(c), c.system->particles);
+        if (bytes == 0) {                       //Bez zapisu kawałek zostaje zamrożony w pamięci
+            ofLogWarning("ChunkedWorld") << "Nie mozna zapisac " << pagePath(c);
+            return;
+        }
+        hide(c);
+        c.capacity = c.system->particles.capacity();
+        c.layout = c.system->particles.layout();
+        c.system->particles = ParticlePool();
+        c.pageBytes = bytes;
+        c.state = ChunkState::Paged;
+        worldMetrics.pagedBytes += bytes;
+        ++worldMetrics.pageOuts;
+    }
+
+    // Odczyt strony; uszkodzona albo brakująca strona - kawałek od nowa w stanie ustalonym
+    void pageIn(Chunk& c, ChunkState state) {
+        const std::string path = pagePath(c);
+        ParticlePool pool;
+        if (!ChunkPage::read(path, pool, c.capacity)) {
+            ofLogError("ChunkedWorld") << "Nie mozna wczytac " << path << " - kawalek od nowa";
+            pool = ParticlePool();
+            pool.setLayout(c.layout);
+            pool.allocate(c.capacity);
+            c.time = time - c.system->emitter.maxLifetime();
+        }
+        std::remove(path.c_str());
+        c.system->particles = std::move(pool);
+        worldMetrics.pagedBytes -= c.pageBytes;
+        c.pageBytes = 0;
+        c.state = state;
+        c.changed = true;
+        ++worldMetrics.pageIns;
+    }
+
+    void rebuildResident() {
+        resident.clear();
+        for (auto& entry : chunks) {
+            if (entry.second->state != ChunkState::Paged) resident.push_back(entry.second.get());
+        }
+    }
+
+    // Nadrabia zaległy czas krokami updateCoarse (najwyżej coarseDt każdy), a aktywny kawałek liczy jeszcze krok dt
+    void advance(Chunk& c, float dt, float coarseDt, const ofVec3f& force) {
+        const bool active = c.state == ChunkState::Active;
+        const double target = active ? time - dt : time;
+        double lag = target - c.time;
+        const double lifetime = c.system->emitter.maxLifetime();
+        if (lag > lifetime) {                   //Wszystkie obecne cząstki i tak by umarły
+            c.system->particles.clear();
+            lag = lifetime;
+        }
+        c.coarseSteps = 0;
+        while (lag > 1e-6) {
+            const float h = float(std::min(lag, double(coarseDt)));
+            c.system->applyForce(force);
+            c.system->updateCoarse(h);
+            lag -= h;
+            ++c.coarseSteps;
+        }
+        if (active) {
+            c.system->applyForce(force);
+            c.system->update(dt);
+        }
+        c.time = time;
+        c.changed = true;
+    }
+
+    // Stan do rysowania i metryki kawałków w pamięci. Zmienione kawałki są usuwane z `particles` od końca
+    // (ostatnio dopisane - zwykle bez przesuwania cząstek) i dopisywane na nowo; pozostałe zostają na miejscu.
+    void gather() {
+        ChunkMetrics& m = worldMetrics;
+        m.active = m.statistical = m.frozen = 0;
+        m.activeParticles = m.residentParticles = 0;
+        m.residentBytes = 0;
+        m.copiedParticles = 0;
+        for (auto it = resident.rbegin(); it != resident.rend(); ++it) {
+            if ((*it)->changed) hide(**it);
+        }
+        for (Chunk* c : resident) {
+            const ParticlePool& p = c->system->particles;
+            switch (c->state) {
+                case ChunkState::Active: ++m.active; m.activeParticles += p.size(); break;
+                case ChunkState::Statistical: ++m.statistical; break;
+                default: ++m.frozen; break;
+            }
+            m.residentParticles += p.size();
+            m.residentBytes += uint64_t(ParticlePool::bytesPerParticle(p.layout())) * p.capacity();
+            if (c->changed) {
+                show(*c);
+                c->changed = false;
+                m.copiedParticles += p.size();
+            }
+        }
+        m.paged = chunks.size() - resident.size();
+        m.queuedPages = pagingQueue.size();
+    }
+
+    // Usuwa cząstki kawałka z `particles`: na każde zwolnione miejsce wchodzi ostatnia cząstka puli.
+    // Indeksy od największego - ostatnia cząstka nigdy nie należy do usuwanego kawałka.
+    void hide(Chunk& c) {
+        std::sort(c.drawn.begin(), c.drawn.end(), std::greater<uint32_t>());
+        size_t n = particles.size();
+        for (uint32_t i : c.drawn) {
+            const size_t last = --n;
+            if (i == last) continue;
+            particles.move(last, i);
+            Chunk* owner = drawnOwner[last];
+            const uint32_t slot = drawnSlot[last];
+            owner->drawn[slot] = i;
+            drawnOwner[i] = owner;
+            drawnSlot[i] = slot;
+        }
+        particles.resize(n);
+        drawnOwner.resize(n);
+        drawnSlot.resize(n);
+        c.drawn.clear();
+    }
+
+    // Dopisuje cząstki kawałka na koniec `particles`
+    void show(Chunk& c) {
+        const size_t first = particles.size();
+        const size_t n = c.system->particles.size();
+        append(c.system->particles);
+        drawnOwner.resize(first + n, &c);
+        drawnSlot.resize(first + n);
+        c.drawn.resize(n);
+        for (size_t k = 0; k < n; ++k) {
+            c.drawn[k] = uint32_t(first + k);
+            drawnSlot[first + k] = uint32_t(k);
+        }
+    }
+
+    // Dopisuje cząstki puli w dowolnym układzie do `particles` (Full)
+    void append(const ParticlePool& src) {
+        const size_t n = src.size();
+        const size_t first = particles.size();
+        particles.resize(first + n);
+        std::copy(src.x.begin(), src.x.end(), particles.x.begin() + first);
+        std::copy(src.y.begin(), src.y.end(), particles.y.begin() + first);
+        std::copy(src.z.begin(), src.z.end(), particles.z.begin() + first);
+        std::copy(src.age.begin(), src.age.end(), particles.age.begin() + first);
+        if (src.halfVelocity()) {
+            src.loadVelocity(0, n, particles.vx.data() + first, particles.vy.data() + first, particles.vz.data() + first);
+        } else {
+            std::copy(src.vx.begin(), src.vx.end(), particles.vx.begin() + first);
+            std::copy(src.vy.begin(), src.vy.end(), particles.vy.begin() + first);
+            std::copy(src.vz.begin(), src.vz.end(), particles.vz.begin() + first);
+        }
+        if (src.compact()) {
+            src.gatherRecords(0, n, particles.invMass.data() + first, particles.lifetime.data() + first);
+            for (size_t i = 0; i < n; ++i) particles.color[first + i] = src.colorAt(i);
+        } else {
+            std::copy(src.lifetime.begin(), src.lifetime.end(), particles.lifetime.begin() + first);
+            std::copy(src.invMass.begin(), src.invMass.end(), particles.invMass.begin() + first);
+            std::copy(src.color.begin(), src.color.end(), particles.color.begin() + first);
+        }
+    }
+};
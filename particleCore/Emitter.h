@@ -0,0 +1,107 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ParticlePool.h"
+#include "RandomStream.h"
+#include "EmitterShapes.h"
+#include <algorithm>
+#include <memory>
+
+// Losowa prędkość nowych cząstek: velocity +- range w każdej osi. Kolejność losowania (najpierw wszystkie x,
+// potem y, potem z) jest ta sama w każdym układzie puli - half dostaje te same liczby, tylko zaokrąglone.
+inline void emitVelocity(RandomStream& random, ParticlePool& pool, size_t first, size_t count, const ofVec3f& velocity, const ofVec3f& range) {
+    if (!pool.halfVelocity()) {
+        random.fill(pool.vx.data() + first, count, velocity.x - range.x, velocity.x + range.x);
+        random.fill(pool.vy.data() + first, count, velocity.y - range.y, velocity.y + range.y);
+        random.fill(pool.vz.data() + first, count, velocity.z - range.z, velocity.z + range.z);
+        return;
+    }
+    const size_t block = 256;                                       //Wielokrotność RandomStream::lanes - ten sam ciąg co jedno fill()
+    float buffer[block];
+    const SimdKernels::Table& k = SimdKernels::active();
+    std::vector<uint16_t>* out[3] = { &pool.hvx, &pool.hvy, &pool.hvz };
+    const float lo[3] = { velocity.x - range.x, velocity.y - range.y, velocity.z - range.z };
+    const float hi[3] = { velocity.x + range.x, velocity.y + range.y, velocity.z + range.z };
+    for (int axis = 0; axis < 3; ++axis) {
+        for (size_t b = 0; b < count; b += block) {
+            const size_t n = std::min(block, count - b);
+            random.fill(buffer, n, lo[axis], hi[axis]);
+            k.packHalf(buffer, out[axis]->data() + first + b, n);
+        }
+    }
+}
+
+// Klasa EmitterBase - Wspólny interfejs emiterów (do trzymania różnych emiterów w EmitterSet)
+// Wywołanie wirtualne jest jedno na emiter i klatkę - cząstki wypełnia już kod konkretnego kształtu.
+class EmitterBase {
+public:
+    virtual ~EmitterBase() {}
+
+    virtual void emit(float dt, ParticlePool& pool) = 0;
+    virtual size_t estimateCapacity() const = 0;        //Maksymalna liczba żywych cząstek z tego emitera
+    virtual float maxLifetime() const = 0;
+    virtual std::unique_ptr<EmitterBase> clone() const = 0;
+};
+
+// Klasa ShapeEmitter - Emiter cząstek z dowolnego kształtu (PointShape, BoxShape, SphereShape, DiscShape, MeshSurfaceShape)
+template<class Shape>
+class ShapeEmitter : public EmitterBase {
+public:
+    Shape shape;                            //Gdzie rodzą się cząstki
+    ofVec3f velocity;                       //Prędkość początkowa (np. dym do góry)
+    ofVec3f velocityRange;                  //Losowe odchylenie prędkości w osiach x, y, z (velocity +- velocityRange)
+    ofColor color;                          //Kolor cząstek generowanych przez emiter
+    float lifetime;                         //Czas życia każdej cząstki w sekundach
+    float emissionRate;                     //Liczba cząstek generowanych na sekundę
+    float timeSinceLastEmit;                //Czas, jaki upłynął od ostatniego wygenerowania cząstki
+    float mass;                             //Masa cząsteczek
+    bool settles;                           //Cząstki osiadają na ziemi (GroundAccumulation) zamiast po prostu znikać
+    RandomStream random;                    //Własny generator emitera - ten sam seed daje te same cząstki
+
+    // Konstruktor (kształt, prędkość, zakres prędkości, kolor, czas życia, szybkość emisji, masa, ziarno)
+    ShapeEmitter(const Shape& s, ofVec3f vel, ofVec3f velRange, ofColor col, float life, float rate, float m, uint64_t seed = 0)
+        : shape(s), velocity(vel), velocityRange(velRange), color(col), lifetime(life),
+          emissionRate(rate), timeSinceLastEmit(0), mass(m), settles(false), random(seed) {}
+
+    //Funkcja emitująca - zapisuje nowe cząstki bezpośrednio w puli (bez tymczasowego wektora)
+    void emit(float dt, ParticlePool& pool) override {
+        if (emissionRate <= 0) return;                              //Emiter wyłączony (np. szybkość 0 w pliku sceny)
+        timeSinceLastEmit += dt;                                    //Dodaje czas, jaki upłynął od ostatniej emisji, aby obliczyć, czy należy wygenerować nowe cząstki
+        int numToEmit = timeSinceLastEmit * emissionRate;           //Oblicza liczbę cząstek, które powinny zostać wygenerowane //np 0.1 sek z 100/sek -> numToEmit = 0.1 * 100 = 10
+        timeSinceLastEmit -= numToEmit / emissionRate;              // Aktualizuje czas, który pozostał po emisji tych cząstek
+
+        //Rezerwuje miejsca na końcu puli z kolorem, czasem życia, masą i flagami emitera (przy pełnej puli nadmiar przepada)
+        const size_t first = pool.spawn(numToEmit, color, lifetime, 1.0f / mass, settles ? ParticleFlags::settles : 0);
+        const size_t count = pool.size() - first;
+        shape.sample(random, pool.x.data() + first, pool.y.data() + first, pool.z.data() + first, count);
+        emitVelocity(random, pool, first, count, velocity, velocityRange);    //Losowa prędkość dla każdej cząstki
+        std::fill_n(pool.age.data() + first, count, 0.0f);
+    }
+
+    // Cząstka żyje `lifetime` plus najwyżej jedną klatkę, a 0.5 s zapasu pokrywa skoki dt
+    size_t estimateCapacity() const override {
+        return size_t(emissionRate * (lifetime + 0.5f)) + 1;
+    }
+
+    float maxLifetime() const override { return lifetime; }
+
+    std::unique_ptr<EmitterBase> clone() const override {
+        return std::unique_ptr<EmitterBase>(new ShapeEmitter(*this));
+    }
+};
+
+// Klasa Emitter    -   Generuje cząstki z jednego punktu
+class Emitter : public ShapeEmitter<PointShape> {
+public:
+    //Konstruktor (pozycja, zakres predkosci, kolor, czas życia, szybkość emisji, masa, ziarno)
+    Emitter(ofVec3f pos, ofVec3f velRange, ofColor col, float life, float rate, float m, uint64_t seed = 0)
+        : ShapeEmitter<PointShape>(PointShape(pos), ofVec3f(0, 0, 0), velRange, col, life, rate, m, seed) {}
+};
+
+// Klasa EmitterSnow - Generuje cząstki z zakresu
+class EmitterSnow : public ShapeEmitter<BoxShape> {
+public:
+    // Konstruktor (pozycja, zakres emisji, zakres prędkości, kolor, czas życia, szybkość emisji, masa, ziarno)
+    EmitterSnow(ofVec3f pos, ofVec3f emitRange, ofVec3f velRange, ofColor col, float life, float rate, float m, uint64_t seed = 0)
+        : ShapeEmitter<BoxShape>(BoxShape(pos, emitRange), ofVec3f(0, 0, 0), velRange, col, life, rate, m, seed) {}
+};
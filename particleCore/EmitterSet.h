@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Emitter.h"
+#include <memory>
+#include <vector>
+
+// Klasa EmitterSet - Dowolna liczba emiterów o różnych kształtach w jednym systemie
+// Spełnia ten sam interfejs co pojedynczy emiter, więc ParticleSystem<EmitterSet> działa bez zmian:
+// wszystkie emitery dopisują cząstki do jednej puli, a potem jedno przejście aktualizuje je razem.
+// Emitery są wołane w kolejności dodania; przy pełnej puli ostatnie emitery tracą nadmiar.
+class EmitterSet {
+public:
+    EmitterSet() {}
+
+    EmitterSet(const EmitterSet& other) {
+        for (const auto& e : other.emitters) {
+            emitters.push_back(e->clone());
+        }
+    }
+
+    EmitterSet& operator=(const EmitterSet& other) {
+        if (this != &other) {
+            EmitterSet copy(other);
+            emitters.swap(copy.emitters);
+        }
+        return *this;
+    }
+
+    EmitterSet(EmitterSet&&) = default;
+    EmitterSet& operator=(EmitterSet&&) = default;
+
+    // Dodaje kopię emitera i zwraca referencję do niej (np. do późniejszej zmiany szybkości emisji)
+    template<class E>
+    E& add(const E& emitter) {
+        E* copy = new E(emitter);
+        emitters.push_back(std::unique_ptr<EmitterBase>(copy));
+        return *copy;
+    }
+
+    size_t size() const { return emitters.size(); }
+    EmitterBase& operator[](size_t i) { return *emitters[i]; }
+    const EmitterBase& operator[](size_t i) const { return *emitters[i]; }
+
+    void emit(float dt, ParticlePool& pool) {
+        for (auto& e : emitters) {
+            e->emit(dt, pool);
+        }
+    }
+
+    size_t estimateCapacity() const {
+        size_t capacity = 0;
+        for (const auto& e : emitters) capacity += e->estimateCapacity();
+        return capacity;
+    }
+
+    float maxLifetime() const {
+        float lifetime = 0;
+        for (const auto& e : emitters) lifetime = std::max(lifetime, e->maxLifetime());
+        return lifetime;
+    }
+
+private:
+    std::vector<std::unique_ptr<EmitterBase>> emitters;
+};
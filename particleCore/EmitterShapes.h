@@ -0,0 +1,144 @@
+#pragma once
+
+#include "ofMain.h"
+#include "RandomStream.h"
+#include <algorithm>
+#include <cmath>
+
+// Kształty emiterów - gdzie rodzą się nowe cząstki
+// Kształt jest parametrem szablonu ShapeEmitter (polityka w czasie kompilacji), więc losowanie
+// pozycji nie przechodzi przez wywołanie wirtualne. Każdy kształt ma jedną metodę:
+//   void sample(RandomStream& random, float* x, float* y, float* z, size_t n) const
+// która wypełnia n pozycji na raz, tablica po tablicy tam, gdzie to możliwe.
+
+// Jeden punkt - wszystkie cząstki startują z tego samego miejsca
+struct PointShape {
+    ofVec3f center;
+
+    PointShape(const ofVec3f& c = ofVec3f(0, 0, 0)) : center(c) {}
+
+    void sample(RandomStream&, float* x, float* y, float* z, size_t n) const {
+        std::fill_n(x, n, center.x);
+        std::fill_n(y, n, center.y);
+        std::fill_n(z, n, center.z);
+    }
+};
+
+// Prostopadłościan center +- halfExtent (jak dawny EmitterSnow)
+struct BoxShape {
+    ofVec3f center;
+    ofVec3f halfExtent;
+
+    BoxShape(const ofVec3f& c, const ofVec3f& half) : center(c), halfExtent(half) {}
+
+    void sample(RandomStream& random, float* x, float* y, float* z, size_t n) const {
+        random.fill(x, n, center.x - halfExtent.x, center.x + halfExtent.x);
+        random.fill(y, n, center.y - halfExtent.y, center.y + halfExtent.y);
+        random.fill(z, n, center.z - halfExtent.z, center.z + halfExtent.z);
+    }
+};
+
+// Kula - równomiernie w objętości albo na powierzchni (surface = true)
+struct SphereShape {
+    ofVec3f center;
+    float radius;
+    bool surface;
+
+    SphereShape(const ofVec3f& c, float r, bool onSurface = false) : center(c), radius(r), surface(onSurface) {}
+
+    void sample(RandomStream& random, float* x, float* y, float* z, size_t n) const {
+        for (size_t i = 0; i < n; ++i) {
+            float cosTheta = random.uniform(-1.0f, 1.0f);           //Kierunek równomiernie na sferze
+            float sinTheta = std::sqrt(std::max(0.0f, 1.0f - cosTheta * cosTheta));
+            float phi = random.uniform(0.0f, TWO_PI);
+            float r = surface ? radius : radius * std::cbrt(random.nextFloat());   //cbrt - równa gęstość w objętości
+            x[i] = center.x + r * sinTheta * std::cos(phi);
+            y[i] = center.y + r * sinTheta * std::sin(phi);
+            z[i] = center.z + r * cosTheta;
+        }
+    }
+};
+
+// Koło o promieniu `radius` prostopadłe do `normal` (np. wylot komina)
+struct DiscShape {
+    ofVec3f center;
+    ofVec3f normal;
+    float radius;
+
+    DiscShape(const ofVec3f& c, const ofVec3f& n, float r) : center(c), normal(n), radius(r) {}
+
+    void sample(RandomStream& random, float* x, float* y, float* z, size_t n) const {
+        ofVec3f axis = normal.getNormalized();
+        ofVec3f helper = std::fabs(axis.y) < 0.9f ? ofVec3f(0, 1, 0) : ofVec3f(1, 0, 0);
+        ofVec3f u = axis.getCrossed(helper).getNormalized();       //Dwa wektory rozpinające płaszczyznę koła
+        ofVec3f v = axis.getCrossed(u);
+        for (size_t i = 0; i < n; ++i) {
+            float r = radius * std::sqrt(random.nextFloat());       //sqrt - równa gęstość na powierzchni koła
+            float phi = random.uniform(0.0f, TWO_PI);
+            float a = r * std::cos(phi), b = r * std::sin(phi);
+            x[i] = center.x + a * u.x + b * v.x;
+            y[i] = center.y + a * u.y + b * v.y;
+            z[i] = center.z + a * u.z + b * v.z;
+        }
+    }
+};
+
+// Powierzchnia siatki trójkątów - trójkąt losowany proporcjonalnie do pola, punkt równomiernie w trójkącie
+struct MeshSurfaceShape {
+    std::vector<ofVec3f> vertices;
+    std::vector<unsigned> indices;          //Po trzy indeksy na trójkąt
+    std::vector<float> cumulativeArea;      //Suma pól trójkątów 0..t
+
+    MeshSurfaceShape(const std::vector<ofVec3f>& verts, const std::vector<unsigned>& tris)
+        : vertices(verts), indices(tris) {
+        computeAreas();
+    }
+
+    // Siatka w trybie OF_PRIMITIVE_TRIANGLES (z indeksami albo bez)
+    explicit MeshSurfaceShape(const ofMesh& mesh) {
+        for (const auto& p : mesh.getVertices()) {
+            vertices.push_back(ofVec3f(p.x, p.y, p.z));
+        }
+        if (mesh.hasIndices()) {
+            indices.assign(mesh.getIndices().begin(), mesh.getIndices().end());
+        } else {
+            for (unsigned i = 0; i < vertices.size(); ++i) indices.push_back(i);
+        }
+        computeAreas();
+    }
+
+    void sample(RandomStream& random, float* x, float* y, float* z, size_t n) const {
+        if (cumulativeArea.empty() || cumulativeArea.back() <= 0) {
+            std::fill_n(x, n, 0.0f);
+            std::fill_n(y, n, 0.0f);
+            std::fill_n(z, n, 0.0f);
+            return;
+        }
+        const float total = cumulativeArea.back();
+        for (size_t i = 0; i < n; ++i) {
+            float pick = random.nextFloat() * total;
+            size_t t = std::upper_bound(cumulativeArea.begin(), cumulativeArea.end(), pick) - cumulativeArea.begin();
+            t = std::min(t, cumulativeArea.size() - 1);
+            const ofVec3f& a = vertices[indices[3 * t]];
+            const ofVec3f& b = vertices[indices[3 * t + 1]];
+            const ofVec3f& c = vertices[indices[3 * t + 2]];
+            float s = std::sqrt(random.nextFloat());                //Współrzędne barycentryczne równomiernie w trójkącie
+            float r = random.nextFloat();
+            float wa = 1.0f - s, wb = s * (1.0f - r), wc = s * r;
+            x[i] = wa * a.x + wb * b.x + wc * c.x;
+            y[i] = wa * a.y + wb * b.y + wc * c.y;
+            z[i] = wa * a.z + wb * b.z + wc * c.z;
+        }
+    }
+
+private:
+    void computeAreas() {
+        cumulativeArea.clear();
+        float sum = 0;
+        for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+            const ofVec3f& a = vertices[indices[t]];
+            sum += 0.5f * (vertices[indices[t + 1]] - a).getCrossed(vertices[indices[t + 2]] - a).length();
+            cumulativeArea.push_back(sum);
+        }
+    }
+};
@@ -0,0 +1,168 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ParticlePool.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+// Klasa FixedStepScheduler - Symulacja ze stałym krokiem na osobnym wątku, niezależna od klatek
+// Wątek symulacji zbiera upływający czas i wykonuje tyle kroków o stałym dt, ile się w nim mieści,
+// ale nie więcej niż maxStepsPerFrame naraz - po długiej przerwie nadmiar czasu jest pomijany,
+// zamiast nadrabiać go coraz dłuższymi seriami kroków (spirala spowolnienia).
+// Po każdej serii kopia puli trafia do potrójnego bufora; rysowanie bierze najnowszą kopię i cofa
+// pozycje o v * rewind, co daje liniową interpolację między dwoma ostatnimi krokami
+// (w kroku p += v * dt, więc poprzedni stan to p - v * dt). Kopia nie zależy od kolejności cząstek,
+// więc usuwanie martwych cząstek między krokami jej nie psuje.
+// System musi mieć pulę `particles`, applyForce(ofVec3f), update(float) i draw(const ParticlePool&, float) const.
+template<class System>
+class FixedStepScheduler {
+public:
+    FixedStepScheduler(System& system, float stepRate = 120.0f, int maxStepsPerFrame = 5)
+        : system(system), stepDt(1.0f / stepRate), maxStepsPerFrame(maxStepsPerFrame),
+          accumulator(0), force(0, 0, 0), stepCount(0), droppedSteps(0), quit(false),
+          readyFresh(false), readyStep(0), renderStep(0) {}
+
+    ~FixedStepScheduler() { stop(); }
+
+    FixedStepScheduler(const FixedStepScheduler&) = delete;
+    FixedStepScheduler& operator=(const FixedStepScheduler&) = delete;
+
+    // Uruchamia wątek symulacji; od tej pory system zmieniamy tylko przez modify()
+    void start() {
+        if (thread.joinable()) return;
+        quit = false;
+        thread = std::thread([this] { run(); });
+    }
+
+    void stop() {
+        quit = true;
+        if (thread.joinable()) thread.join();
+    }
+
+    bool running() const { return thread.joinable(); }
+
+    // Wykonuje kroki za `elapsed` sekund czasu rzeczywistego na wątku wywołującym
+    // (wątek symulacji; bez start() - np. w benchmarku). Zwraca liczbę wykonanych kroków.
+    int advance(double elapsed) {
+        std::lock_guard<std::mutex> lock(simMutex);
+        return advanceLocked(elapsed);
+    }
+
+    // Stała siła działająca w każdym kroku (np. wiatr); ParticleSystem skaluje ją przez dt
+    void setForce(const ofVec3f& f) {
+        std::lock_guard<std::mutex> lock(forceMutex);
+        force = f;
+    }
+
+    // Zmiana systemu z wątku głównego (klawisze, liczba wątków) - między krokami symulacji
+    template<class F>
+    void modify(F fn) {
+        std::lock_guard<std::mutex> lock(simMutex);
+        fn(system);
+    }
+
+    // Rysuje najnowszy stan z interpolacją; wywoływane z ofApp::draw
+    void draw() {
+        Clock::time_point stateTime;
+        {
+            std::lock_guard<std::mutex> lock(snapshotMutex);
+            if (readyFresh) {
+                std::swap(ready, render);
+                renderTime = readyTime;
+                renderStep = readyStep;
+                readyFresh = false;
+            }
+            stateTime = renderTime;
+        }
+        // Rysujemy chwilę sprzed jednego kroku: tuż po kroku stan jest cofnięty o cały krok,
+        // a tuż przed następnym - pokazany bez cofania
+        float rewind = std::chrono::duration<float>(stateTime - Clock::now()).count() + stepDt;
+        rewind = std::min(std::max(rewind, 0.0f), stepDt);
+        system.draw(render, rewind);
+    }
+
+    size_t renderedCount() const { return render.size(); }     //Liczba cząstek w rysowanym stanie
+    const ParticlePool& renderedState() const { return render; }   //Stan z ostatniego draw() (np. do nagrywania)
+    uint64_t renderedStep() const { return renderStep; }        //Numer kroku tego stanu - zmienia się, gdy przyszedł nowy
+    float getStepDt() const { return stepDt; }
+    uint64_t getStepCount() const { return stepCount; }
+    uint64_t getDroppedSteps() const { return droppedSteps; }      //Kroki pominięte przez limit nadrabiania
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    System& system;
+    const float stepDt;
+    const int maxStepsPerFrame;
+    double accumulator;                     //Czas rzeczywisty jeszcze nie zasymulowany (< stepDt po serii)
+
+    std::mutex forceMutex;
+    ofVec3f force;
+
+    std::mutex simMutex;                    //Trzymany przez wątek symulacji w czasie serii kroków
+    std::atomic<uint64_t> stepCount;
+    std::atomic<uint64_t> droppedSteps;
+    std::atomic<bool> quit;
+    std::thread thread;
+
+    // Potrójny bufor stanu: back (zapisywany przez symulację), ready (najnowszy gotowy), render (rysowany)
+    std::mutex snapshotMutex;
+    ParticlePool back, ready, render;
+    Clock::time_point readyTime, renderTime;    //Chwila czasu rzeczywistego, której odpowiada stan
+    bool readyFresh;
+    uint64_t readyStep, renderStep;         //Liczba kroków wykonanych przed zapisaniem stanu
+
+    int advanceLocked(double elapsed) {
+        accumulator += elapsed;
+        ofVec3f stepForce;
+        {
+            std::lock_guard<std::mutex> lock(forceMutex);
+            stepForce = force;
+        }
+        int steps = 0;
+        while (accumulator >= stepDt && steps < maxStepsPerFrame) {
+            system.applyForce(stepForce);
+            system.update(stepDt);
+            accumulator -= stepDt;
+            ++steps;
+        }
+        if (accumulator >= stepDt) {                        //Limit nadrabiania - reszta czasu przepada
+            uint64_t dropped = uint64_t(accumulator / stepDt);
+            droppedSteps += dropped;
+            accumulator -= dropped * double(stepDt);
+        }
+        stepCount += steps;
+        return steps;
+    }
+
+    void run() {
+        Clock::time_point last = Clock::now();
+        while (!quit) {
+            Clock::time_point now = Clock::now();
+            double elapsed = std::chrono::duration<double>(now - last).count();
+            last = now;
+
+            double untilNextStep;
+            {
+                std::lock_guard<std::mutex> lock(simMutex);
+                if (advanceLocked(elapsed) > 0) {
+                    publish(now - std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(accumulator)));
+                }
+                untilNextStep = stepDt - accumulator;
+            }
+            std::this_thread::sleep_until(now + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(untilNextStep)));
+        }
+    }
+
+    // Kopiuje pulę do bufora `back` i wymienia go z `ready` (bez alokacji, gdy pula nie rośnie)
+    void publish(Clock::time_point stateTime) {
+        back = system.particles;
+        std::lock_guard<std::mutex> lock(snapshotMutex);
+        std::swap(back, ready);
+        readyTime = stateTime;
+        readyStep = stepCount;
+        readyFresh = true;
+    }
+};
@@ -0,0 +1,170 @@
+#pragma once
+
+#include "ofMain.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+// Rodzaj pola sił
+enum class FieldType {
+    Gravity,                                //Stałe przyspieszenie (niezależne od masy)
+    Drag,                                   //Opór: F = -(linear + quadratic * |v|) * v
+    Attractor,                              //Przyciąganie do punktu (ujemna siła - odpychanie)
+    Vortex,                                 //Wir wokół osi przez punkt
+    CurlNoise                               //Turbulencja - rotacja pola szumu, bez źródeł i ujść
+};
+
+// Jedno pole sił - znaczenie parametrów zależy od typu
+struct ForceField {
+    FieldType type;
+    ofVec3f point;                          //Gravity: przyspieszenie; Attractor/Vortex: środek
+    ofVec3f axis;                           //Vortex: oś wiru (znormalizowana)
+    float strength;                         //Attractor/Vortex/CurlNoise: siła; Drag: współczynnik liniowy
+    float radius;                           //Attractor/Vortex: zasięg (0 = bez ograniczenia); Drag: współczynnik kwadratowy
+    float frequency;                        //CurlNoise: skala przestrzenna szumu (1 / długość fali)
+    float timeScale;                        //CurlNoise: szybkość zmian szumu w czasie
+};
+
+// Klasa ForceFieldStack - Zestaw pól sił liczonych w jednym przejściu po cząstkach
+// apply() bierze blok cząstek (mieszczący się w L1), dla każdego pola dodaje przyspieszenie do
+// tablic bloku (pętla bez rozgałęzień po typie - kompilator może ją zwektoryzować), a na końcu
+// raz zmienia prędkość: v += a * dt. Pozycje i prędkości są czytane z pamięci raz, niezależnie od liczby pól.
+// Pola są czystymi funkcjami pozycji, prędkości i czasu - wynik nie zależy od liczby wątków.
+class ForceFieldStack {
+public:
+    float time;                             //Czas pól zależnych od czasu (CurlNoise), przesuwany w ParticleSystem::update
+
+    ForceFieldStack() : time(0) {}
+
+    bool empty() const { return fields.empty(); }
+    size_t size() const { return fields.size(); }
+    void clear() { fields.clear(); }
+    ForceField& operator[](size_t i) { return fields[i]; }
+    const ForceField& operator[](size_t i) const { return fields[i]; }
+
+    void addGravity(const ofVec3f& acceleration) {
+        fields.push_back(ForceField{ FieldType::Gravity, acceleration, ofVec3f(0, 0, 0), 0, 0, 0, 0 });
+    }
+
+    void addDrag(float linear, float quadratic = 0.0f) {
+        fields.push_back(ForceField{ FieldType::Drag, ofVec3f(0, 0, 0), ofVec3f(0, 0, 0), linear, quadratic, 0, 0 });
+    }
+
+    void addAttractor(const ofVec3f& center, float strength, float radius = 0.0f) {
+        fields.push_back(ForceField{ FieldType::Attractor, center, ofVec3f(0, 0, 0), strength, radius, 0, 0 });
+    }
+
+    void addVortex(const ofVec3f& center, const ofVec3f& axis, float strength, float radius) {
+        fields.push_back(ForceField{ FieldType::Vortex, center, axis.getNormalized(), strength, radius, 0, 0 });
+    }
+
+    void addCurlNoise(float strength, float frequency, float timeScale = 0.0f) {
+        fields.push_back(ForceField{ FieldType::CurlNoise, ofVec3f(0, 0, 0), ofVec3f(0, 0, 0), strength, 0, frequency, timeScale });
+    }
+
+    // Dodaje do prędkości przyspieszenia wszystkich pól za czas dt (zakres puli: wskaźniki na początek zakresu)
+    void apply(const float* x, const float* y, const float* z, float* vx, float* vy, float* vz,
+               const float* invMass, size_t n, float dt) const {
+        float ax[blockSize], ay[blockSize], az[blockSize];
+        for (size_t begin = 0; begin < n; begin += blockSize) {
+            const size_t count = std::min(blockSize, n - begin);
+            std::fill_n(ax, count, 0.0f);
+            std::fill_n(ay, count, 0.0f);
+            std::fill_n(az, count, 0.0f);
+            for (const ForceField& f : fields) {
+                accumulate(f, x + begin, y + begin, z + begin, vx + begin, vy + begin, vz + begin,
+                           invMass + begin, count, ax, ay, az);
+            }
+            for (size_t i = 0; i < count; ++i) {
+                vx[begin + i] += ax[i] * dt;
+                vy[begin + i] += ay[i] * dt;
+                vz[begin + i] += az[i] * dt;
+            }
+        }
+    }
+
+private:
+    static const size_t blockSize = 256;
+
+    std::vector<ForceField> fields;
+
+    void accumulate(const ForceField& f, const float* x, const float* y, const float* z,
+                    const float* vx, const float* vy, const float* vz, const float* invMass, size_t n,
+                    float* ax, float* ay, float* az) const {
+        switch (f.type) {
+            case FieldType::Gravity:
+                for (size_t i = 0; i < n; ++i) {
+                    ax[i] += f.point.x;
+                    ay[i] += f.point.y;
+                    az[i] += f.point.z;
+                }
+                break;
+
+            case FieldType::Drag:
+                for (size_t i = 0; i < n; ++i) {
+                    float speed = std::sqrt(vx[i] * vx[i] + vy[i] * vy[i] + vz[i] * vz[i]);
+                    float k = -(f.strength + f.radius * speed) * invMass[i];
+                    ax[i] += k * vx[i];
+                    ay[i] += k * vy[i];
+                    az[i] += k * vz[i];
+                }
+                break;
+
+            case FieldType::Attractor: {
+                // a = strength * (c - p) / (d^2 + 1)^(3/2) - jak grawitacja (~1/d^2), łagodne przy środku, zero poza zasięgiem
+                const float r2 = f.radius > 0 ? f.radius * f.radius : std::numeric_limits<float>::max();
+                for (size_t i = 0; i < n; ++i) {
+                    float dx = f.point.x - x[i], dy = f.point.y - y[i], dz = f.point.z - z[i];
+                    float d2 = dx * dx + dy * dy + dz * dz;
+                    float k = d2 < r2 ? f.strength / ((d2 + 1.0f) * std::sqrt(d2 + 1.0f)) : 0.0f;
+                    ax[i] += k * dx;
+                    ay[i] += k * dy;
+                    az[i] += k * dz;
+                }
+                break;
+            }
+
+            case FieldType::Vortex: {
+                // Przyspieszenie styczne: axis x r, słabnące liniowo do zera na brzegu zasięgu
+                const float invRadius = f.radius > 0 ? 1.0f / f.radius : 0.0f;
+                for (size_t i = 0; i < n; ++i) {
+                    float rx = x[i] - f.point.x, ry = y[i] - f.point.y, rz = z[i] - f.point.z;
+                    float tx = f.axis.y * rz - f.axis.z * ry;
+                    float ty = f.axis.z * rx - f.axis.x * rz;
+                    float tz = f.axis.x * ry - f.axis.y * rx;
+                    float d = std::sqrt(tx * tx + ty * ty + tz * tz);   //Odległość od osi (|axis x r|)
+                    float falloff = std::max(0.0f, 1.0f - d * invRadius);
+                    float k = f.strength * falloff / (d + 1.0f);
+                    ax[i] += k * tx;
+                    ay[i] += k * ty;
+                    az[i] += k * tz;
+                }
+                break;
+            }
+
+            case FieldType::CurlNoise: {
+                // Rotacja potencjału (psi1, psi2, psi3) z trzech przesuniętych kopii szumu, pochodne różnicami w przód
+                const float e = 0.01f;                              //Krok różniczkowania w jednostkach szumu
+                const float t = time * f.timeScale;
+                const float scale = f.strength / e;
+                for (size_t i = 0; i < n; ++i) {
+                    float px = x[i] * f.frequency, py = y[i] * f.frequency, pz = z[i] * f.frequency;
+                    float p1 = ofSignedNoise(px, py, pz, t);
+                    float p2 = ofSignedNoise(px + 31.4f, py + 47.2f, pz + 12.9f, t);
+                    float p3 = ofSignedNoise(px + 73.1f, py + 5.7f, pz + 91.3f, t);
+                    float d1dy = ofSignedNoise(px, py + e, pz, t) - p1;
+                    float d1dz = ofSignedNoise(px, py, pz + e, t) - p1;
+                    float d2dx = ofSignedNoise(px + 31.4f + e, py + 47.2f, pz + 12.9f, t) - p2;
+                    float d2dz = ofSignedNoise(px + 31.4f, py + 47.2f, pz + 12.9f + e, t) - p2;
+                    float d3dx = ofSignedNoise(px + 73.1f + e, py + 5.7f, pz + 91.3f, t) - p3;
+                    float d3dy = ofSignedNoise(px + 73.1f, py + 5.7f + e, pz + 91.3f, t) - p3;
+                    ax[i] += scale * (d3dy - d2dz);
+                    ay[i] += scale * (d1dz - d3dx);
+                    az[i] += scale * (d2dx - d1dy);
+                }
+                break;
+            }
+        }
+    }
+};
@@ -0,0 +1,251 @@
+#pragma once
+
+#include "AllocationCounter.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Etapy mierzone przez FrameProfiler
+enum class ProfileStage : uint8_t {
+    Update,                                 //Cały ParticleSystem::update (czas ściany)
+    Emit,                                   //Emisja nowych cząstek
+    Interactions,                           //Oddziaływania cząstka-cząstka (SpatialHash)
+    Forces,                                 //Siła z applyForce i pola sił
+    Integrate,                              //Ruch i wiek
+    Collide,                                //Kolizje z kulami (i przebudowa siatki kul)
+    Reap,                                   //Zliczanie i usuwanie martwych cząstek
+    Draw,                                   //Wysłanie cząstek do rysowania (ParticleSystem::draw)
+    Count
+};
+
+// Klasa FrameProfiler - Pomiar czasu etapów symulacji i rysowania
+// ProfileScope zapisuje zdarzenie (etap, numer klatki, wątek, początek, czas trwania) do bufora
+// pierścieniowego bez blokad: wątek rezerwuje slot przez fetch_add, a numer sekwencyjny slotu
+// (jak w seqlock) mówi czytelnikowi, czy zdarzenie jest kompletne. Przy wyłączonym profilerze
+// pomiar to jeden odczyt atomowej flagi. Bufor trzyma ostatnie `capacity` zdarzeń.
+// Wątek główny wywołuje collect(), które sumuje czasy etapu w klatce (po wszystkich wątkach)
+// i trzyma ostatnie `window` sum - z nich liczone są mediana i 99. percentyl.
+class FrameProfiler {
+public:
+    static const size_t capacity = 1 << 16;         //Potęga dwójki
+    static const size_t window = 240;               //Klatki w oknie percentyli (2 s przy 120 Hz)
+
+    FrameProfiler()
+        : slots(capacity), active(false), writeIndex(0), readIndex(0), lostEvents(0),
+          epoch(std::chrono::steady_clock::now()) {
+        for (Slot& s : slots) s.sequence.store(0, std::memory_order_relaxed);
+        for (StageHistory& h : history) h.samples.reserve(window);
+    }
+
+    FrameProfiler(const FrameProfiler&) = delete;
+    FrameProfiler& operator=(const FrameProfiler&) = delete;
+
+    // Profiler wspólny dla całego programu (ParticleSystem i aplikacje)
+    static FrameProfiler& global() {
+        static FrameProfiler profiler;
+        return profiler;
+    }
+
+    static const char* stageName(ProfileStage s) {
+        switch (s) {
+            case ProfileStage::Update: return "Update";
+            case ProfileStage::Emit: return "Emit";
+            case ProfileStage::Interactions: return "Interactions";
+            case ProfileStage::Forces: return "Forces";
+            case ProfileStage::Integrate: return "Integrate";
+            case ProfileStage::Collide: return "Collide";
+            case ProfileStage::Reap: return "Reap";
+            case ProfileStage::Draw: return "Draw";
+            case ProfileStage::Count: break;
+        }
+        return "";
+    }
+
+    void setEnabled(bool on) { active.store(on, std::memory_order_relaxed); }
+    bool enabled() const { return active.load(std::memory_order_relaxed); }
+
+    uint64_t nowNs() const {                        //Nanosekundy od utworzenia profilera
+        return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count());
+    }
+
+    // Zapisuje zdarzenie [startNs, endNs) - bezpieczne z wielu wątków naraz
+    void record(ProfileStage stage, uint32_t frame, uint64_t startNs, uint64_t endNs) {
+        const uint64_t i = writeIndex.fetch_add(1, std::memory_order_relaxed);
+        Slot& s = slots[i & (capacity - 1)];
+        const uint64_t duration = std::min<uint64_t>(endNs - startNs, 0xffffffffu);
+        s.sequence.store(0, std::memory_order_relaxed);                 //Slot w trakcie zapisu
+        std::atomic_thread_fence(std::memory_order_release);
+        s.start.store(startNs, std::memory_order_relaxed);
+        s.info.store(duration | (uint64_t(stage) << 32) | (uint64_t(threadIndex()) << 40) | (uint64_t(frame & 0xffff) << 48),
+                     std::memory_order_relaxed);
+        s.sequence.store(i + 1, std::memory_order_release);
+    }
+
+    // Przenosi nowe zdarzenia z bufora do statystyk etapów (wątek główny)
+    void collect() {
+        const uint64_t end = writeIndex.load(std::memory_order_acquire);
+        if (end - readIndex > capacity) {                               //Bufor przepełniony między wywołaniami
+            lostEvents += end - capacity - readIndex;
+            readIndex = end - capacity;
+        }
+        Event e;
+        for (; readIndex < end; ++readIndex) {
+            int state = read(readIndex, e);
+            if (state < 0) break;                                       //Zdarzenie jeszcze zapisywane - dokończymy później
+            if (state == 0) {
+                ++lostEvents;
+                continue;
+            }
+            StageHistory& h = history[size_t(e.stage)];
+            if (h.hasFrame && h.frame != e.frame) {
+                h.push(float(h.sumNs * 1e-6));
+                h.sumNs = 0;
+            }
+            h.hasFrame = true;
+            h.frame = e.frame;
+            h.sumNs += e.durationNs;
+        }
+    }
+
+    // Percentyl (0..1) sum czasu etapu w klatce z okna, w milisekundach; 0 gdy brak pomiarów
+    float percentileMs(ProfileStage stage, float p) const {
+        const std::vector<float>& samples = history[size_t(stage)].samples;
+        if (samples.empty()) return 0.0f;
+        sorted.assign(samples.begin(), samples.end());
+        size_t k = std::min(sorted.size() - 1, size_t(p * (sorted.size() - 1) + 0.5f));
+        std::nth_element(sorted.begin(), sorted.begin() + k, sorted.end());
+        return sorted[k];
+    }
+
+    size_t sampleCount(ProfileStage stage) const { return history[size_t(stage)].samples.size(); }
+    uint64_t eventCount() const { return writeIndex.load(std::memory_order_relaxed); }
+    uint64_t getLostEvents() const { return lostEvents; }
+
+    // Tabela do nakładki: p50/p99 każdego mierzonego etapu, liczba cząstek i alokacji
+    std::string report(size_t liveParticles) const {
+        std::string text = "Etap          p50 ms  p99 ms";
+        char line[64];
+        for (size_t s = 0; s < size_t(ProfileStage::Count); ++s) {
+            ProfileStage stage = ProfileStage(s);
+            if (sampleCount(stage) == 0) continue;
+            std::snprintf(line, sizeof(line), "\n%-12s %7.3f %7.3f", stageName(stage), percentileMs(stage, 0.5f), percentileMs(stage, 0.99f));
+            text += line;
+        }
+        text += "\nCzastki: " + std::to_string(liveParticles) + ", alokacje: " + std::to_string(AllocationCounter::allocations());
+        return text;
+    }
+
+    // Zapisuje zdarzenia z bufora (ostatnie `capacity`) jako JSON dla chrome://tracing / Perfetto
+    bool exportChromeTrace(const std::string& path) const {
+        std::ofstream out(path);
+        if (!out) return false;
+        out << "{\"traceEvents\":[";
+        const uint64_t end = writeIndex.load(std::memory_order_acquire);
+        const uint64_t begin = end > capacity ? end - capacity : 0;
+        bool first = true;
+        char line[192];
+        Event e;
+        for (uint64_t i = begin; i < end; ++i) {
+            if (read(i, e) <= 0) continue;
+            std::snprintf(line, sizeof(line), "%s\n{\"name\":\"%s\",\"cat\":\"particles\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u,\"args\":{\"frame\":%u}}",
+                          first ? "" : ",", stageName(e.stage), e.startNs * 1e-3, e.durationNs * 1e-3, unsigned(e.thread), unsigned(e.frame));
+            out << line;
+            first = false;
+        }
+        out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+        return bool(out);
+    }
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> sequence;     //Indeks zdarzenia + 1, gdy slot jest kompletny; 0 w trakcie zapisu
+        std::atomic<uint64_t> start;
+        std::atomic<uint64_t> info;         //Czas trwania (32 bity) | etap (8) | wątek (8) | klatka (16)
+    };
+
+    struct Event {
+        uint64_t startNs;
+        uint32_t durationNs;
+        ProfileStage stage;
+        uint8_t thread;
+        uint16_t frame;
+    };
+
+    struct StageHistory {
+        std::vector<float> samples;         //Okno ostatnich sum (ms), nadpisywane w kółko
+        size_t next = 0;
+        bool hasFrame = false;
+        uint16_t frame = 0;
+        uint64_t sumNs = 0;                 //Suma bieżącej klatki (jeszcze niezamknięta)
+
+        void push(float ms) {
+            if (samples.size() < window) {
+                samples.push_back(ms);
+            } else {
+                samples[next] = ms;
+            }
+            next = (next + 1) % window;
+        }
+    };
+
+    std::vector<Slot> slots;
+    std::atomic<bool> active;
+    std::atomic<uint64_t> writeIndex;
+    uint64_t readIndex;                     //Pozycja collect() - tylko wątek główny
+    uint64_t lostEvents;
+    std::chrono::steady_clock::time_point epoch;
+    StageHistory history[size_t(ProfileStage::Count)];
+    mutable std::vector<float> sorted;
+
+    // 1 - zdarzenie odczytane, 0 - nadpisane nowszym, -1 - jeszcze niezapisane
+    int read(uint64_t i, Event& e) const {
+        const Slot& s = slots[i & (capacity - 1)];
+        const uint64_t before = s.sequence.load(std::memory_order_acquire);
+        if (before != i + 1) return before > i + 1 ? 0 : -1;
+        const uint64_t start = s.start.load(std::memory_order_relaxed);
+        const uint64_t info = s.info.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (s.sequence.load(std::memory_order_relaxed) != before) return 0;
+        e.startNs = start;
+        e.durationNs = uint32_t(info);
+        e.stage = ProfileStage((info >> 32) & 0xff);
+        e.thread = uint8_t(info >> 40);
+        e.frame = uint16_t(info >> 48);
+        return 1;
+    }
+
+    static uint8_t threadIndex() {          //Mały numer wątku do śladu (kolejność pierwszego pomiaru)
+        static std::atomic<uint8_t> nextThread(0);
+        thread_local uint8_t index = nextThread.fetch_add(1, std::memory_order_relaxed);
+        return index;
+    }
+};
+
+// Klasa ProfileScope - Mierzy czas od utworzenia do końca zakresu (RAII)
+class ProfileScope {
+public:
+    ProfileScope(ProfileStage stage, uint32_t frame)
+        : stage(stage), frame(frame), start(FrameProfiler::global().enabled() ? FrameProfiler::global().nowNs() : noStart) {}
+
+    ~ProfileScope() {
+        if (start != noStart) {
+            FrameProfiler& profiler = FrameProfiler::global();
+            profiler.record(stage, frame, start, profiler.nowNs());
+        }
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    static const uint64_t noStart = uint64_t(-1);
+
+    ProfileStage stage;
+    uint32_t frame;
+    uint64_t start;
+};
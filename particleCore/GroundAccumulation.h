@@ -0,0 +1,305 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ParticlePool.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+// Cząstki jednego zakresu puli, które osiadły na ziemi (wynik GroundAccumulation::collect)
+struct GroundBatch {
+    size_t begin;                           //Początek zakresu - kolejność dokładania śniegu
+    std::vector<uint32_t> indices;          //Indeksy osiadłych cząstek w puli
+
+    GroundBatch() : begin(0) {}
+};
+
+// Klasa GroundAccumulation - Warstwa śniegu na ziemi zamiast leżących płatków
+// Ziemia to siatka resolution x resolution węzłów nad kwadratem center +- size / 2 (w osiach x i z):
+// wysokość terenu (stała, z łagodnymi pagórkami) plus grubość śniegu w węźle.
+// collect() w równoległym przejściu po zakresach puli usuwa każdą cząstkę, która znalazła się pod powierzchnią
+// (oznacza ją jako martwą - usunie ją reapDead w tym samym kroku), a cząstki z flagą ParticleFlags::settles
+// (emiter z flagą settles) odkłada do paczki zakresu. deposit() szeregowo, w kolejności zakresów, dokłada
+// ich śnieg do czterech najbliższych węzłów (wagi dwuliniowe - gładka warstwa bez pojedynczych słupków),
+// więc warstwa nie zależy od liczby wątków. Powierzchnia w collect() to stan z poprzedniego kroku.
+// setup(), clear() i deposit() zmieniają siatkę tylko na wątku symulacji (poza przejściem równoległym).
+// Rysowanie: jedna siatka o stałej liczbie wierzchołków w buforze na GPU; draw() wysyła tylko wiersze siatki
+// zmienione od poprzedniej klatki. Śnieg na ziemi kosztuje więc stałą siatkę, nie tysiące żywych cząstek.
+class GroundAccumulation {
+public:
+    float depthPerParticle;                 //Przyrost grubości śniegu od jednego płatka (rozłożony na 4 węzły)
+    float maxDepth;                         //Najgrubsza warstwa - dalsze płatki w tym miejscu znikają bez śladu
+    float coverDepth;                       //Grubość, od której ziemia jest całkiem biała (kolor przy rysowaniu)
+    ofColor snowColor;                      //Kolor grubej warstwy śniegu przy rysowaniu
+    ofColor groundColor;
+
+    GroundAccumulation() : depthPerParticle(2.0f), maxDepth(150.0f), coverDepth(10.0f), snowColor(255, 255, 255),
+                           groundColor(40, 45, 40), center(0, 0, 0), size(0), hillHeight(0), resolution(0), cell(0),
+                           settled(0), deposited(0), gpuReady(false), indexCount(0), uploadedRows(0) {}
+
+    GroundAccumulation(const GroundAccumulation&) = delete;
+    GroundAccumulation& operator=(const GroundAccumulation&) = delete;
+
+    // Nowa siatka (bez śniegu): środek (y - wysokość ziemi), bok kwadratu, liczba węzłów w wierszu, wysokość pagórków.
+    // Rozdzielczość 0 wyłącza ziemię.
+    void setup(const ofVec3f& groundCenter, float groundSize, int nodes, float hills = 0.0f) {
+        std::lock_guard<std::mutex> lock(mutex);
+        center = groundCenter;
+        size = groundSize;
+        hillHeight = hills;
+        resolution = nodes > 1 && groundSize > 0 ? nodes : 0;
+        cell = resolution > 1 ? size / float(resolution - 1) : 0.0f;
+        const size_t count = size_t(resolution) * size_t(resolution);
+        terrain.assign(count, 0.0f);
+        depth.assign(count, 0.0f);
+        dirtyRows.assign(size_t(resolution), 1);
+        for (int j = 0; j < resolution; ++j) {
+            for (int i = 0; i < resolution; ++i) {
+                const float x = originX() + float(i) * cell, z = originZ() + float(j) * cell;
+                terrain[index(i, j)] = center.y + hillHeight * std::sin(x * 0.003f) * std::cos(z * 0.004f);
+            }
+        }
+        settled.store(0, std::memory_order_relaxed);
+        deposited.store(0, std::memory_order_relaxed);
+        gpuReady = false;                   //Inna liczba wierzchołków - bufory od nowa przy rysowaniu
+    }
+
+    bool enabled() const { return resolution > 1; }
+    int getResolution() const { return resolution; }
+    float getSize() const { return size; }
+    const ofVec3f& getCenter() const { return center; }
+    float getHillHeight() const { return hillHeight; }
+
+    // Usuwa cały śnieg (teren zostaje)
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::fill(depth.begin(), depth.end(), 0.0f);
+        std::fill(dirtyRows.begin(), dirtyRows.end(), 1);
+        settled.store(0, std::memory_order_relaxed);
+        deposited.store(0, std::memory_order_relaxed);
+    }
+
+    // Cząstki [begin, end) jednego zakresu puli: każda pod powierzchnią jest oznaczana jako martwa,
+    // a osiadające (ParticleFlags::settles) trafiają do `batch`. Wywoływane równolegle dla rozłącznych zakresów,
+    // w tym samym przejściu co ruch cząstek - czyta tylko teren i śnieg z poprzedniego kroku, bez blokady.
+    // Zwraca liczbę usuniętych cząstek.
+    size_t collect(ParticlePool& pool, size_t begin, size_t end, GroundBatch& batch) {
+        batch.begin = begin;
+        batch.indices.clear();
+        if (!enabled()) return 0;
+        const float dead = std::numeric_limits<float>::infinity();
+        size_t removed = 0;
+        for (size_t p = begin; p < end; ++p) {
+            float w[4];
+            size_t k[4];
+            int row;
+            if (!weights(pool.x[p], pool.z[p], w, k, row)) continue;
+            float surface = 0;
+            for (int c = 0; c < 4; ++c) surface += w[c] * (terrain[k[c]] + depth[k[c]]);
+            if (pool.y[p] > surface || pool.isDead(p)) continue;
+            if (pool.flagsAt(p) & ParticleFlags::settles) batch.indices.push_back(uint32_t(p));
+            pool.age[p] = dead;             //isDead: wiek > czas życia - usunie reapDead
+            ++removed;
+        }
+        settled.fetch_add(removed, std::memory_order_relaxed);
+        return removed;
+    }
+
+    // Śnieg od cząstek z paczek collect(), szeregowo w kolejności zakresów puli -
+    // ta sama warstwa dla każdej liczby wątków i każdego podziału na zakresy
+    void deposit(const ParticlePool& pool, GroundBatch* batches, size_t count) {
+        std::sort(batches, batches + count, [](const GroundBatch& a, const GroundBatch& b) { return a.begin < b.begin; });
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t added = 0;
+        for (size_t b = 0; b < count; ++b) {
+            for (uint32_t p : batches[b].indices) {
+                float w[4];
+                size_t k[4];
+                int row;
+                if (!weights(pool.x[p], pool.z[p], w, k, row)) continue;        //collect() brał tylko cząstki nad siatką
+                for (int c = 0; c < 4; ++c) depth[k[c]] = std::min(maxDepth, depth[k[c]] + w[c] * depthPerParticle);
+                dirtyRows[size_t(row)] = dirtyRows[size_t(row) + 1] = 1;
+            }
+            added += batches[b].indices.size();
+        }
+        deposited.fetch_add(added, std::memory_order_relaxed);
+    }
+
+    // collect() i deposit() dla całej puli w jednej paczce. Zwraca liczbę usuniętych cząstek.
+    size_t settle(ParticlePool& pool) {
+        GroundBatch batch;
+        const size_t removed = collect(pool, 0, pool.size(), batch);
+        deposit(pool, &batch, 1);
+        return removed;
+    }
+
+    // Wysokość powierzchni (teren + śnieg) w punkcie (x, z), interpolowana; poza siatką - wysokość środka
+    float heightAt(float x, float z) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!enabled()) return center.y;
+        const float last = float(resolution - 1);
+        const float fx = std::min(std::max((x - originX()) / cell, 0.0f), last);
+        const float fz = std::min(std::max((z - originZ()) / cell, 0.0f), last);
+        const int i = std::min(int(fx), resolution - 2), j = std::min(int(fz), resolution - 2);
+        const float tx = fx - float(i), tz = fz - float(j);
+        auto h = [&](int a, int b) { return terrain[index(a, b)] + depth[index(a, b)]; };
+        return (1 - tx) * (1 - tz) * h(i, j) + tx * (1 - tz) * h(i + 1, j) + (1 - tx) * tz * h(i, j + 1) + tx * tz * h(i + 1, j + 1);
+    }
+
+    // Liczniki czytane z wątku głównego w trakcie symulacji (atomowe - bez blokady)
+    size_t settledCount() const { return settled.load(std::memory_order_relaxed); }      //Cząstki usunięte na ziemi od setup()
+    size_t depositedCount() const { return deposited.load(std::memory_order_relaxed); }  //W tym płatki, które dołożyły śnieg
+
+    // Suma i maksimum grubości śniegu w węzłach
+    float totalDepth() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        double sum = 0;
+        for (float d : depth) sum += d;
+        return float(sum);
+    }
+
+    float maxSnowDepth() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return depth.empty() ? 0.0f : *std::max_element(depth.begin(), depth.end());
+    }
+
+    const std::vector<float>& depths() const { return depth; }     //Tylko gdy symulacja stoi (benchmark)
+
+    // Przepisuje zmienione wiersze do tablicy wierzchołków i zwraca ich liczbę (bez OpenGL - draw() wysyła je na GPU)
+    size_t refreshVertices() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        const size_t count = size_t(resolution) * size_t(resolution);
+        if (vertices.size() != count) {
+            vertices.resize(count);
+            std::fill(dirtyRows.begin(), dirtyRows.end(), 1);
+        }
+        uploadRuns.clear();
+        size_t rows = 0;
+        for (int j = 0; j < resolution; ++j) {
+            if (!dirtyRows[size_t(j)]) continue;
+            dirtyRows[size_t(j)] = 0;
+            ++rows;
+            for (int i = 0; i < resolution; ++i) {
+                const size_t k = index(i, j);
+                vertices[k] = glm::vec4(originX() + float(i) * cell, terrain[k] + depth[k], originZ() + float(j) * cell, depth[k]);
+            }
+            if (!uploadRuns.empty() && uploadRuns.back().second == j) {
+                ++uploadRuns.back().second;             //Sąsiednie wiersze - jeden ciągły zakres bufora
+            } else {
+                uploadRuns.push_back(std::make_pair(j, j + 1));
+            }
+        }
+        return rows;
+    }
+
+    size_t lastUploadedRows() const { return uploadedRows; }
+
+    // Rysuje siatkę ziemi (wątek główny; symulacja może w tym czasie osadzać śnieg)
+    void draw() const {
+        if (!enabled()) return;
+        if (!gpuReady) setupGpu();
+        uploadedRows = refreshVertices();
+        const size_t rowBytes = size_t(resolution) * sizeof(glm::vec4);
+        for (const auto& run : uploadRuns) {
+            vertexBuffer.updateData(size_t(run.first) * rowBytes, size_t(run.second - run.first) * rowBytes,
+                                    vertices.data() + size_t(run.first) * size_t(resolution));
+        }
+        shader.begin();
+        shader.setUniform3f("groundColor", groundColor.r / 255.0f, groundColor.g / 255.0f, groundColor.b / 255.0f);
+        shader.setUniform3f("snowColor", snowColor.r / 255.0f, snowColor.g / 255.0f, snowColor.b / 255.0f);
+        shader.setUniform1f("coverDepth", coverDepth);
+        vbo.drawElements(GL_TRIANGLES, int(indexCount));
+        shader.end();
+    }
+
+private:
+    mutable std::mutex mutex;               //deposit() na wątku symulacji, draw() i odczyty na wątku głównym
+    ofVec3f center;
+    float size;
+    float hillHeight;
+    int resolution;                         //Węzłów w wierszu (0 - ziemia wyłączona)
+    float cell;                             //Odstęp węzłów
+    std::vector<float> terrain;             //Wysokość terenu w węźle
+    std::vector<float> depth;               //Grubość śniegu w węźle
+    mutable std::vector<uint8_t> dirtyRows; //Wiersze zmienione od ostatniego refreshVertices
+    std::atomic<size_t> settled, deposited;
+
+    // Strona GPU: wierzchołki (x, wysokość, z, grubość śniegu) i stałe indeksy trójkątów
+    mutable bool gpuReady;
+    mutable std::vector<glm::vec4> vertices;
+    mutable std::vector<std::pair<int, int>> uploadRuns;    //Zakresy wierszy [od, do) do wysłania
+    mutable ofBufferObject vertexBuffer;
+    mutable ofVbo vbo;
+    mutable ofShader shader;
+    mutable size_t indexCount;
+    mutable size_t uploadedRows;
+
+    float originX() const { return center.x - size * 0.5f; }
+    float originZ() const { return center.z - size * 0.5f; }
+    size_t index(int i, int j) const { return size_t(j) * size_t(resolution) + size_t(i); }
+
+    // Cztery węzły wokół punktu (x, z) i ich wagi dwuliniowe; false poza siatką (także NaN)
+    bool weights(float x, float z, float* w, size_t* k, int& row) const {
+        const float fx = (x - originX()) / cell, fz = (z - originZ()) / cell;
+        const float last = float(resolution - 1);
+        if (!(fx >= 0 && fz >= 0 && fx <= last && fz <= last)) return false;
+        const int i = std::min(int(fx), resolution - 2), j = std::min(int(fz), resolution - 2);
+        const float tx = fx - float(i), tz = fz - float(j);
+        w[0] = (1 - tx) * (1 - tz); w[1] = tx * (1 - tz); w[2] = (1 - tx) * tz; w[3] = tx * tz;
+        k[0] = index(i, j); k[1] = index(i + 1, j); k[2] = index(i, j + 1); k[3] = index(i + 1, j + 1);
+        row = j;
+        return true;
+    }
+
+    void setupGpu() const {
+        std::vector<ofIndexType> indices;
+        indices.reserve(size_t(resolution - 1) * size_t(resolution - 1) * 6);
+        for (int j = 0; j + 1 < resolution; ++j) {
+            for (int i = 0; i + 1 < resolution; ++i) {
+                const ofIndexType a = ofIndexType(index(i, j)), b = ofIndexType(index(i + 1, j));
+                const ofIndexType c = ofIndexType(index(i, j + 1)), d = ofIndexType(index(i + 1, j + 1));
+                indices.insert(indices.end(), { a, c, b, b, c, d });
+            }
+        }
+        indexCount = indices.size();
+        vertexBuffer.allocate(size_t(resolution) * size_t(resolution) * sizeof(glm::vec4), GL_DYNAMIC_DRAW);
+        vbo.setVertexBuffer(vertexBuffer, 4, sizeof(glm::vec4));
+        vbo.setIndexData(indices.data(), int(indices.size()), GL_STATIC_DRAW);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            vertices.clear();               //refreshVertices przepisze wszystkie wiersze
+        }
+
+        if (!shader.isLoaded()) {
+            shader.setupShaderFromSource(GL_VERTEX_SHADER, R"(
+                #version 150
+                uniform mat4 modelViewProjectionMatrix;
+                uniform vec3 groundColor;
+                uniform vec3 snowColor;
+                uniform float coverDepth;
+                in vec4 position;                   // x, wysokość, z, grubość śniegu
+                out vec4 vColor;
+                void main() {
+                    float cover = clamp(position.w / coverDepth, 0.0, 1.0);
+                    vColor = vec4(mix(groundColor, snowColor, cover), 1.0);
+                    gl_Position = modelViewProjectionMatrix * vec4(position.xyz, 1.0);
+                }
+            )");
+            shader.setupShaderFromSource(GL_FRAGMENT_SHADER, R"(
+                #version 150
+                in vec4 vColor;
+                out vec4 fragColor;
+                void main() {
+                    fragColor = vColor;
+                }
+            )");
+            shader.bindDefaults();
+            shader.linkProgram();
+        }
+        gpuReady = true;
+    }
+};
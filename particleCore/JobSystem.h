@@ -0,0 +1,169 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Klasa JobSystem - Pula wątków z podkradaniem pracy (work stealing) dla pętli równoległych
+// parallelFor dzieli zakres [0, count) na kawałki i rozkłada je po kolejkach wątków.
+// Każdy wątek (także wywołujący) bierze kawałki z własnej kolejki, a gdy ta się opróżni,
+// podkrada kawałki z początku kolejek innych wątków. Kolejki mają stałą pojemność, więc
+// wywołanie parallelFor nie alokuje pamięci.
+class JobSystem {
+public:
+    // Liczba wątków łącznie z wywołującym; 0 = liczba rdzeni
+    explicit JobSystem(unsigned threadCount = 0)
+        : stopping(false), generation(0), currentFn(nullptr), currentCtx(nullptr), remaining(0) {
+        if (threadCount == 0) {
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+        }
+        for (unsigned i = 0; i < threadCount; ++i) {
+            queues.emplace_back(new WorkQueue());
+        }
+        for (unsigned i = 1; i < threadCount; ++i) {
+            workers.emplace_back(&JobSystem::workerLoop, this, i);
+        }
+    }
+
+    ~JobSystem() {
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            stopping = true;
+        }
+        wakeCv.notify_all();
+        for (auto& t : workers) {
+            t.join();
+        }
+    }
+
+    unsigned threadCount() const { return unsigned(queues.size()); }
+
+    // Wywołuje fn(begin, end) dla kawałków zakresu [0, count) o rozmiarze co najmniej minChunk.
+    // Wraca, gdy wszystkie kawałki są przetworzone. Kawałki nie zachodzą na siebie.
+    template<class F>
+    void parallelFor(size_t count, size_t minChunk, F& fn) {
+        if (count == 0) return;
+        if (queues.size() == 1 || count <= minChunk) {
+            fn(size_t(0), count);
+            return;
+        }
+        run(count, minChunk, &invoke<F>, &fn);
+    }
+
+private:
+    typedef void (*InvokeFn)(void*, size_t, size_t);
+
+    struct Range {
+        size_t begin, end;
+    };
+
+    // Kolejka kawałków jednego wątku: właściciel bierze od końca, złodzieje od początku
+    struct WorkQueue {
+        static const size_t capacity = 256;
+        std::mutex mutex;
+        Range ranges[capacity];
+        size_t head = 0, tail = 0;
+
+        bool popBack(Range& r) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (head == tail) return false;
+            r = ranges[--tail];
+            return true;
+        }
+
+        bool stealFront(Range& r) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (head == tail) return false;
+            r = ranges[head++];
+            return true;
+        }
+    };
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;     //[0] należy do wątku wywołującego parallelFor
+    std::vector<std::thread> workers;
+    std::mutex wakeMutex;
+    std::condition_variable wakeCv;
+    bool stopping;
+    uint64_t generation;                                //Zwiększane przy każdym parallelFor - budzi wątki
+    InvokeFn currentFn;
+    void* currentCtx;
+    std::atomic<size_t> remaining;                      //Liczba kawałków jeszcze nieprzetworzonych
+
+    template<class F>
+    static void invoke(void* ctx, size_t begin, size_t end) {
+        (*static_cast<F*>(ctx))(begin, end);
+    }
+
+    void run(size_t count, size_t minChunk, InvokeFn fn, void* ctx) {
+        const size_t threads = queues.size();
+        const size_t maxChunks = threads * WorkQueue::capacity;
+        size_t chunk = std::max(minChunk, (count + maxChunks - 1) / maxChunks);
+        size_t chunks = (count + chunk - 1) / chunk;
+
+        currentFn = fn;
+        currentCtx = ctx;
+        remaining.store(chunks, std::memory_order_release);
+
+        // Każdy wątek dostaje ciągły blok kawałków - sąsiednie cząstki trafiają do tego samego rdzenia
+        size_t perThread = (chunks + threads - 1) / threads;
+        for (size_t t = 0; t < threads; ++t) {
+            WorkQueue& q = *queues[t];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            q.head = q.tail = 0;
+            size_t firstChunk = t * perThread;
+            size_t lastChunk = std::min(chunks, firstChunk + perThread);
+            for (size_t c = lastChunk; c > firstChunk; --c) {  //Odwrotnie: właściciel zdejmuje od końca, więc idzie od początku bloku
+                size_t begin = (c - 1) * chunk;
+                q.ranges[q.tail++] = Range{ begin, std::min(count, begin + chunk) };
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            ++generation;
+        }
+        wakeCv.notify_all();
+
+        work(0);
+        while (remaining.load(std::memory_order_acquire) > 0) {     //Czekanie na kawałki przetwarzane przez inne wątki
+            std::this_thread::yield();
+        }
+    }
+
+    void work(size_t self) {
+        Range r;
+        while (remaining.load(std::memory_order_acquire) > 0) {
+            if (queues[self]->popBack(r) || steal(self, r)) {
+                currentFn(currentCtx, r.begin, r.end);
+                remaining.fetch_sub(1, std::memory_order_acq_rel);
+            } else {
+                return;                                         //Wszystkie kolejki puste - reszta jest już w trakcie
+            }
+        }
+    }
+
+    bool steal(size_t self, Range& r) {
+        const size_t threads = queues.size();
+        for (size_t k = 1; k < threads; ++k) {
+            if (queues[(self + k) % threads]->stealFront(r)) return true;
+        }
+        return false;
+    }
+
+    void workerLoop(size_t self) {
+        uint64_t seen = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(wakeMutex);
+                wakeCv.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+            }
+            work(self);
+        }
+    }
+};
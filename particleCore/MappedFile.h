@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Klasa MappedFile - Plik zmapowany w pamięci tylko do odczytu (mmap / MapViewOfFile)
+// Strony pliku są wczytywane przez system dopiero przy pierwszym dostępie, więc otwarcie
+// dużego nagrania nie kopiuje go do pamięci procesu.
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path);     //false, gdy pliku nie ma albo jest pusty
+    void close();
+
+    bool isOpen() const { return bytes != nullptr; }
+    const uint8_t* data() const { return bytes; }
+    size_t size() const { return length; }
+
+private:
+    const uint8_t* bytes;
+    size_t length;
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#else
+    int fd;
+#endif
+};
@@ -0,0 +1,219 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ParticlePool.h"
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Widok kamery do odrzucania cząstek: 6 płaszczyzn ostrosłupa widzenia i wiersz macierzy dający głębokość (w)
+// Macierze są zapisane kolumnami jak w glm: m[4 * kolumna + wiersz].
+struct CullingView {
+    float planes[6][4];                     //n.x, n.y, n.z, d - znormalizowane, wnętrze: n . p + d >= 0
+    float depthRow[4];                      //w = depthRow . (p, 1) - odległość wzdłuż osi kamery
+    float screenRows[2][4];                 //x i y w przestrzeni przycięcia - po podzieleniu przez w współrzędne ekranu
+    float viewportWidth, viewportHeight;
+    float pointScale;                       //Piksele na jednostkę w odległości 1 (P[1][1] * wysokość widoku / 2)
+
+    // Płaszczyzny z macierzy projekcja * widok (metoda Gribba-Hartmanna)
+    static CullingView fromViewProjection(const float m[16], float projectionYScale, float viewportWidth, float viewportHeight) {
+        CullingView v;
+        float rows[4][4];
+        for (int r = 0; r < 4; ++r) {
+            for (int c = 0; c < 4; ++c) rows[r][c] = m[4 * c + r];
+        }
+        for (int p = 0; p < 6; ++p) {
+            const float sign = (p % 2 == 0) ? 1.0f : -1.0f;   //lewa/prawa, dół/góra, blisko/daleko
+            const float* axis = rows[p / 2];
+            for (int c = 0; c < 4; ++c) {
+                v.planes[p][c] = rows[3][c] + sign * axis[c];
+            }
+            float len = std::sqrt(v.planes[p][0] * v.planes[p][0] + v.planes[p][1] * v.planes[p][1] + v.planes[p][2] * v.planes[p][2]);
+            for (int c = 0; c < 4; ++c) v.planes[p][c] /= len;
+        }
+        for (int c = 0; c < 4; ++c) {
+            v.depthRow[c] = rows[3][c];
+            v.screenRows[0][c] = rows[0][c];
+            v.screenRows[1][c] = rows[1][c];
+        }
+        v.viewportWidth = viewportWidth;
+        v.viewportHeight = viewportHeight;
+        v.pointScale = projectionYScale * viewportHeight * 0.5f;
+        return v;
+    }
+
+    // Widok z bieżących macierzy OF (wewnątrz cam.begin() / cam.end())
+    static CullingView fromCurrentMatrices() {
+        glm::mat4 projection = ofGetCurrentMatrix(OF_MATRIX_PROJECTION);
+        glm::mat4 modelView = ofGetCurrentMatrix(OF_MATRIX_MODELVIEW);
+        float m[16];
+        for (int c = 0; c < 4; ++c) {
+            for (int r = 0; r < 4; ++r) {
+                float sum = 0;
+                for (int k = 0; k < 4; ++k) sum += projection[k][r] * modelView[c][k];
+                m[4 * c + r] = sum;
+            }
+        }
+        return fromViewProjection(m, projection[1][1], ofGetViewportWidth(), ofGetViewportHeight());
+    }
+
+    // Kamera perspektywiczna bez OpenGL (benchmark): oko, punkt docelowy, kąt widzenia w pionie w stopniach
+    static CullingView perspective(const ofVec3f& eye, const ofVec3f& target, const ofVec3f& up,
+                                   float fovY, float aspect, float nearClip, float farClip, float viewportHeight) {
+        ofVec3f f = (target - eye).getNormalized();
+        ofVec3f s = f.getCrossed(up).getNormalized();
+        ofVec3f u = s.getCrossed(f);
+        float view[16] = { s.x, u.x, -f.x, 0,  s.y, u.y, -f.y, 0,  s.z, u.z, -f.z, 0,
+                           -s.dot(eye), -u.dot(eye), f.dot(eye), 1 };
+        float t = 1.0f / std::tan(fovY * float(PI) / 360.0f);
+        float proj[16] = { t / aspect, 0, 0, 0,  0, t, 0, 0,  0, 0, (farClip + nearClip) / (nearClip - farClip), -1,
+                           0, 0, 2 * farClip * nearClip / (nearClip - farClip), 0 };
+        float m[16];
+        for (int c = 0; c < 4; ++c) {
+            for (int r = 0; r < 4; ++r) {
+                float sum = 0;
+                for (int k = 0; k < 4; ++k) sum += proj[4 * k + r] * view[4 * c + k];
+                m[4 * c + r] = sum;
+            }
+        }
+        return fromViewProjection(m, t, viewportHeight * aspect, viewportHeight);
+    }
+};
+
+// Progi LOD w pikselach średnicy cząstki na ekranie
+struct LodSettings {
+    float meshPixels;                       //Od tej średnicy cząstka jest kulą z siatki
+    float subPixel;                         //Poniżej - cząstka trafia do kafelka ekranu zamiast być osobnym punktem
+    int aggregateTile;                      //Bok kafelka w pikselach; jeden punkt na niepusty kafelek
+
+    LodSettings() : meshPixels(6.0f), subPixel(1.0f), aggregateTile(2) {}
+};
+
+// Punkt zbiorczy: wszystkie cząstki sub-pikselowe z jednego kafelka ekranu
+// Pozycja i kolor to średnie ważone pokryciem, a przezroczystość - suma pokrycia (d^2 w pikselach) / pole kafelka.
+struct LodAggregate {
+    float x, y, z;
+    float r, g, b, a;
+    float coverage;
+    uint32_t count;                         //Liczba cząstek w kafelku
+    uint32_t tile;                          //Indeks kafelka (wiersz * tilesX + kolumna)
+};
+
+// Wynik podziału cząstek na koszyki LOD w jednej klatce
+// Indeksy cząstek są trzymane w tablicach o pojemności puli - bez alokacji w stanie ustalonym.
+struct LodBuckets {
+    std::vector<uint32_t> meshes;           //Kule z siatki (blisko kamery)
+    std::vector<uint32_t> sprites;          //Punkty skalowane z odległością (co najmniej piksel)
+    std::vector<LodAggregate> aggregates;   //Punkty zbiorcze cząstek sub-pikselowych - jeden na niepusty kafelek
+    size_t culled;                          //Poza ostrosłupem widzenia - nie są wysyłane na GPU
+    size_t subPixel;                        //Cząstki mniejsze niż piksel (zebrane w `aggregates`)
+
+    LodBuckets() : culled(0), subPixel(0), tilesX(0), tilesY(0) {}
+
+    size_t total() const { return meshes.size() + sprites.size() + subPixel + culled; }
+    size_t gpuItems() const { return meshes.size() + sprites.size() + aggregates.size(); }   //Obiekty wysyłane na GPU
+
+    std::vector<int32_t> tileSlot;          //Indeks w `aggregates` dla każdego kafelka (-1 = pusty)
+    int tilesX, tilesY;
+};
+
+// Odrzucanie cząstek poza kadrem i wybór LOD - jedno przejście po puli
+// Pozycja to p - v * rewind (jak przy rysowaniu z interpolacją FixedStepScheduler).
+// Cząstki sub-pikselowe są zbierane w kafelki ekranu (LodSettings::aggregateTile) - na GPU idzie jeden punkt
+// na niepusty kafelek, więc ich koszt zależy od pokrytych pikseli, a nie od liczby cząstek.
+namespace ParticleCulling {
+
+    inline void classify(const ParticlePool& pool, float radius, float rewind, const CullingView& view,
+                         const LodSettings& lod, LodBuckets& out) {
+        const size_t n = pool.size();
+        out.meshes.clear();
+        out.sprites.clear();
+        out.aggregates.clear();
+        out.culled = 0;
+        out.subPixel = 0;
+        if (out.meshes.capacity() < n) {                //Rośnie tylko razem z pulą
+            out.meshes.reserve(std::max(n, pool.capacity()));
+            out.sprites.reserve(std::max(n, pool.capacity()));
+        }
+        const int tile = std::max(lod.aggregateTile, 1);
+        const int tilesX = std::max(int(std::ceil(view.viewportWidth / float(tile))), 1);
+        const int tilesY = std::max(int(std::ceil(view.viewportHeight / float(tile))), 1);
+        if (tilesX != out.tilesX || tilesY != out.tilesY) {    //Nowy rozmiar okna albo kafelka
+            out.tilesX = tilesX;
+            out.tilesY = tilesY;
+            out.tileSlot.assign(size_t(tilesX) * size_t(tilesY), -1);
+            out.aggregates.reserve(out.tileSlot.size());
+        }
+
+        const float diameterScale = 2.0f * radius * view.pointScale;
+        const float halfWidth = 0.5f * view.viewportWidth, halfHeight = 0.5f * view.viewportHeight;
+        const float invTile = 1.0f / float(tile);
+        for (size_t i = 0; i < n; ++i) {
+            const ofVec3f v = pool.velocity(i);
+            const float px = pool.x[i] - v.x * rewind;
+            const float py = pool.y[i] - v.y * rewind;
+            const float pz = pool.z[i] - v.z * rewind;
+
+            bool inside = true;
+            for (int p = 0; p < 6; ++p) {
+                const float* pl = view.planes[p];
+                if (pl[0] * px + pl[1] * py + pl[2] * pz + pl[3] < -radius) {
+                    inside = false;
+                    break;
+                }
+            }
+            if (!inside) {
+                ++out.culled;
+                continue;
+            }
+
+            const float w = view.depthRow[0] * px + view.depthRow[1] * py + view.depthRow[2] * pz + view.depthRow[3];
+            const float pixels = diameterScale / std::max(w, 1e-6f);
+            if (pixels >= lod.meshPixels) {
+                out.meshes.push_back(uint32_t(i));
+            } else if (pixels >= lod.subPixel) {
+                out.sprites.push_back(uint32_t(i));
+            } else {
+                // Kafelek ekranu: współrzędne przycięcia / w -> piksele (w > 0, bo cząstka jest przed płaszczyzną bliską)
+                const float invW = 1.0f / std::max(w, 1e-6f);
+                const float sx = (view.screenRows[0][0] * px + view.screenRows[0][1] * py + view.screenRows[0][2] * pz + view.screenRows[0][3]) * invW;
+                const float sy = (view.screenRows[1][0] * px + view.screenRows[1][1] * py + view.screenRows[1][2] * pz + view.screenRows[1][3]) * invW;
+                const int tx = std::min(std::max(int((sx + 1.0f) * halfWidth * invTile), 0), tilesX - 1);
+                const int ty = std::min(std::max(int((sy + 1.0f) * halfHeight * invTile), 0), tilesY - 1);
+                const uint32_t tileIndex = uint32_t(ty) * uint32_t(tilesX) + uint32_t(tx);
+                int32_t& slot = out.tileSlot[tileIndex];
+                if (slot < 0) {
+                    slot = int32_t(out.aggregates.size());
+                    out.aggregates.push_back(LodAggregate{ 0, 0, 0, 0, 0, 0, 0, 0, 0, tileIndex });
+                }
+                const ofColor c = pool.colorAt(i);
+                const float coverage = pixels * pixels;
+                LodAggregate& a = out.aggregates[size_t(slot)];
+                a.x += coverage * px;
+                a.y += coverage * py;
+                a.z += coverage * pz;
+                a.r += coverage * c.r;
+                a.g += coverage * c.g;
+                a.b += coverage * c.b;
+                a.a += coverage * c.a;
+                a.coverage += coverage;
+                ++a.count;
+                ++out.subPixel;
+            }
+        }
+
+        // Sumy -> średnie; kafelki zerowane przez listę punktów zbiorczych (bez czyszczenia całego ekranu)
+        const float tileArea = float(tile * tile);
+        for (LodAggregate& a : out.aggregates) {
+            const float inv = 1.0f / std::max(a.coverage, 1e-12f);
+            a.x *= inv;
+            a.y *= inv;
+            a.z *= inv;
+            a.r *= inv / 255.0f;
+            a.g *= inv / 255.0f;
+            a.b *= inv / 255.0f;
+            a.a = a.a * inv / 255.0f * std::min(1.0f, a.coverage / tileArea);
+            out.tileSlot[a.tile] = -1;
+        }
+    }
+}
@@ -0,0 +1,165 @@
+#pragma once
+
+#include "ParticlePool.h"
+#include "SpatialHash.h"
+#include "JobSystem.h"
+
+// Rodzaj oddziaływania między cząstkami
+enum class InteractionMode {
+    None,                                   //Cząstki niezależne (domyślnie)
+    Repulsion,                              //Odpychanie na krótkim dystansie - cząstki nie nachodzą na siebie
+    Clumping,                               //Zlepianie płatków - przyciąganie do sąsiadów, odpychanie poniżej połowy promienia
+    Density                                 //W stylu SPH - ciśnienie z lokalnej gęstości rozpycha zbite cząstki
+};
+
+// Klasa ParticleInteractions - Oddziaływania cząstka-cząstka w promieniu `radius`
+// Co klatkę haszowana siatka (SpatialHash) jest budowana od nowa, a każda cząstka
+// przegląda tylko sąsiednie komórki - O(n) zamiast O(n^2). Przejście po cząstkach
+// czyta tylko pozycje (i gęstość) sąsiadów, a zapisuje tylko własną prędkość, więc
+// może iść równolegle na JobSystem i daje ten sam wynik przy każdej liczbie wątków.
+// Cząstki są przeglądane komórka po komórce: 27 sąsiednich komórek jest wyszukiwanych raz na komórkę,
+// a pozycje i gęstość są czytane z posortowanych kopii - sąsiednie zapytania trafiają w te same dane.
+class ParticleInteractions {
+public:
+    InteractionMode mode;
+    float radius;                           //Promień oddziaływania (jednocześnie bok komórki siatki)
+    float strength;                         //Przyspieszenie przy pełnym oddziaływaniu (Density: sztywność ciśnienia)
+    float restDensity;                      //Density: gęstość bez ciśnienia (ok. liczba sąsiadów ważona jądrem)
+
+    ParticleInteractions()
+        : mode(InteractionMode::None), radius(10.0f), strength(50.0f), restDensity(4.0f) {}
+
+    bool enabled() const { return mode != InteractionMode::None; }
+
+    static const char* modeName(InteractionMode m) {
+        switch (m) {
+            case InteractionMode::None: return "None";
+            case InteractionMode::Repulsion: return "Repulsion";
+            case InteractionMode::Clumping: return "Clumping";
+            case InteractionMode::Density: return "Density";
+        }
+        return "";
+    }
+
+    void nextMode() {
+        mode = InteractionMode((int(mode) + 1) % 4);
+    }
+
+    // Dodaje do prędkości przyspieszenia od sąsiadów za czas dt
+    void apply(ParticlePool& pool, float dt, JobSystem* jobs) {
+        const size_t n = pool.size();
+        if (!enabled() || n == 0) return;
+
+        hash.build(pool.x.data(), pool.y.data(), pool.z.data(), n, radius);
+        const size_t cells = hash.cellCount();
+
+        if (mode == InteractionMode::Density) {
+            density.resize(n);
+            auto densityKernel = [&](size_t begin, size_t end) { computeDensity(begin, end); };
+            run(jobs, cells, densityKernel);
+        }
+        auto forceKernel = [&](size_t begin, size_t end) { applyForces(pool, begin, end, dt); };
+        run(jobs, cells, forceKernel);
+    }
+
+    const SpatialHash& spatialHash() const { return hash; }
+
+private:
+    SpatialHash hash;
+    std::vector<float> density;             //Gęstość w kolejności posortowanych cząstek (SpatialHash::order)
+
+    template<class F>
+    static void run(JobSystem* jobs, size_t cells, F& kernel) {
+        if (jobs) {
+            jobs->parallelFor(cells, 256, kernel);
+        } else {
+            kernel(size_t(0), cells);
+        }
+    }
+
+    // Gęstość: suma jądra (1 - r^2/h^2)^3 po sąsiadach, łącznie z samą cząstką (komórki [beginCell, endCell))
+    void computeDensity(size_t beginCell, size_t endCell) {
+        const float h2 = radius * radius;
+        const float* sx = hash.positionsX();
+        const float* sy = hash.positionsY();
+        const float* sz = hash.positionsZ();
+        uint32_t rangeBegin[SpatialHash::maxRanges], rangeEnd[SpatialHash::maxRanges];
+        for (size_t c = beginCell; c < endCell; ++c) {
+            const int ranges = hash.neighbourRanges(c, rangeBegin, rangeEnd);      //Raz dla wszystkich cząstek komórki
+            for (uint32_t k = hash.cellBegin(c); k < hash.cellEnd(c); ++k) {
+                const float px = sx[k], py = sy[k], pz = sz[k];
+                float rho = 0;
+                for (int r = 0; r < ranges; ++r) {
+                    for (uint32_t q = rangeBegin[r]; q < rangeEnd[r]; ++q) {
+                        float dx = sx[q] - px, dy = sy[q] - py, dz = sz[q] - pz;
+                        float d2 = dx * dx + dy * dy + dz * dz;
+                        if (d2 < h2) {
+                            float w = 1.0f - d2 / h2;
+                            rho += w * w * w;
+                        }
+                    }
+                }
+                density[k] = rho;
+            }
+        }
+    }
+
+    void applyForces(ParticlePool& pool, size_t beginCell, size_t endCell, float dt) {
+        if (mode == InteractionMode::Repulsion) {
+            applyForces<InteractionMode::Repulsion>(pool, beginCell, endCell, dt);
+        } else if (mode == InteractionMode::Clumping) {
+            applyForces<InteractionMode::Clumping>(pool, beginCell, endCell, dt);
+        } else {
+            applyForces<InteractionMode::Density>(pool, beginCell, endCell, dt);
+        }
+    }
+
+    // Pętla po sąsiadach bez rozgałęzień (tryb jest parametrem szablonu, poza promieniem przyspieszenie 0),
+    // więc kompilator może ją zwektoryzować; sama cząstka ma d2 == 0 i też daje 0
+    template<InteractionMode M>
+    void applyForces(ParticlePool& pool, size_t beginCell, size_t endCell, float dt) {
+        const float invH = 1.0f / radius;
+        const float h2 = radius * radius;
+        const float k = strength;
+        const float rest = restDensity;
+        const std::vector<uint32_t>& order = hash.order();
+        const float* sx = hash.positionsX();
+        const float* sy = hash.positionsY();
+        const float* sz = hash.positionsZ();
+        const float* rho = density.data();
+        uint32_t rangeBegin[SpatialHash::maxRanges], rangeEnd[SpatialHash::maxRanges];
+        for (size_t c = beginCell; c < endCell; ++c) {
+            const int ranges = hash.neighbourRanges(c, rangeBegin, rangeEnd);
+            for (uint32_t p = hash.cellBegin(c); p < hash.cellEnd(c); ++p) {
+                const float px = sx[p], py = sy[p], pz = sz[p];
+                const float ownPressure = M == InteractionMode::Density ? rho[p] - rest : 0.0f;
+                float ax = 0, ay = 0, az = 0;
+                for (int r = 0; r < ranges; ++r) {
+                    for (uint32_t q = rangeBegin[r]; q < rangeEnd[r]; ++q) {
+                        const float dx = sx[q] - px, dy = sy[q] - py, dz = sz[q] - pz;    //Od cząstki p do sąsiada q
+                        const float d2 = dx * dx + dy * dy + dz * dz;
+                        const bool near = d2 < h2 && d2 > 0;
+                        const float d = std::sqrt(near ? d2 : h2);
+                        float a;                                                //Przyspieszenie w kierunku sąsiada (ujemne = od sąsiada)
+                        if (M == InteractionMode::Repulsion) {
+                            a = -k * (1.0f - d * invH);
+                        } else if (M == InteractionMode::Clumping) {
+                            a = k * (d * invH - 0.5f);
+                        } else {
+                            const float w = 1.0f - d * invH;                   //Gradient jądra "spiky" (1 - r/h)^2
+                            const float pressure = 0.5f * (ownPressure + (rho[q] - rest));
+                            a = -k * pressure * w * w / std::max(rho[q], 1e-6f);
+                        }
+                        a = near ? a / d : 0.0f;                                //Normalizacja kierunku (dx, dy, dz)
+                        ax += a * dx;
+                        ay += a * dy;
+                        az += a * dz;
+                    }
+                }
+                const uint32_t i = order[p];
+                const float scale = dt * pool.invMassAt(i);
+                pool.addVelocity(i, ax * scale, ay * scale, az * scale);
+            }
+        }
+    }
+};
@@ -0,0 +1,394 @@
+#pragma once
+
+#include "ofMain.h"
+#include "SimdKernels.h"
+#include <algorithm>
+#include <cstdint>
+
+// Flagi cząstki (bity pola flags / EmitterRecord::flags)
+namespace ParticleFlags {
+    const uint8_t settles = 1;              //Osiada na ziemi (GroundAccumulation) - cząstki emitera z flagą settles
+}
+
+// Klasa Particle       -       Pojedyncza cząstka jako wartość (używana przy emisji i przy kopiowaniu danych z puli)
+class Particle {
+public:
+    ofVec3f position;                       //Początkowa pozycja cząstki.
+    ofVec3f velocity;                       //Początkowa prędkość
+    ofColor color;                          //Początkowy kolor
+    float lifetime;                         //Czas życia w sekundach
+    float age;                              //Wiek
+    float mass;                             //Masa początkowa
+    uint8_t flags;                          //ParticleFlags
+
+    Particle(ofVec3f pos, ofVec3f vel, ofColor col, float life, float m, uint8_t f = 0)
+        : position(pos), velocity(vel), color(col), lifetime(life), age(0), mass(m), flags(f) {}
+};
+
+// Sposób usuwania martwych cząstek z puli
+enum class ReapMode {
+    SwapAndPop,                             //Martwa cząstka zastępowana ostatnią - O(1) na cząstkę, zmienia kolejność
+    StablePartition                         //Jedno przejście z zachowaniem kolejności żywych cząstek
+};
+
+// Układ danych w ParticlePool
+enum class PoolLayout {
+    Full,                                   //Kolor, czas życia, masa i flagi osobno dla każdej cząstki - 41 B na cząstkę
+    Compact,                                //Kolor, czas życia, masa i flagi we wspólnym rekordzie emitera, cząstka ma jego numer - 29 B
+    CompactHalf                             //Jak Compact, a prędkość w połowie precyzji (half) - 23 B
+};
+
+// Wspólne pola cząstek jednego emitera (PoolLayout::Compact i CompactHalf)
+struct EmitterRecord {
+    ofColor color;
+    float lifetime;
+    float invMass;
+    uint8_t flags;                          //Część tożsamości rekordu - emiter bez settles nie dzieli rekordu ze śniegiem
+};
+
+// Klasa ParticlePool   -       Przechowuje wszystkie cząstki w układzie struct-of-arrays
+// Każde pole ma osobną, ciągłą tablicę, więc pętla która czyta tylko pozycję i prędkość
+// nie ściąga do cache koloru, wieku ani masy pozostałych cząstek.
+// W układzie Compact cząstki z jednego emitera nie powtarzają koloru, czasu życia i masy -
+// trzymają tylko 1-bajtowy numer rekordu (emitterIndex); CompactHalf zapisuje też prędkość jako half
+// (hvx, hvy, hvz zamiast vx, vy, vz). Nieużywane tablice danego układu są puste.
+class ParticlePool {
+public:
+    std::vector<float> x, y, z;             //Pozycje
+    std::vector<float> vx, vy, vz;          //Prędkości (Full, Compact)
+    std::vector<float> age;                 //Wiek w sekundach
+    std::vector<float> lifetime;            //Czas życia w sekundach (Full)
+    std::vector<float> invMass;             //Odwrotność masy (1/m) - mnożenie zamiast dzielenia przy sile (Full)
+    std::vector<ofColor> color;             //Kolor (Full)
+    std::vector<uint8_t> flags;             //ParticleFlags (Full)
+    std::vector<uint8_t> emitterIndex;      //Numer rekordu w emitterRecords (Compact, CompactHalf)
+    std::vector<uint16_t> hvx, hvy, hvz;    //Prędkości jako half (CompactHalf)
+    std::vector<EmitterRecord> emitterRecords;
+
+    static const size_t npos = size_t(-1);
+    static const size_t maxRecords = 256;   //Numer rekordu mieści się w uint8_t
+
+    ParticlePool() : maxParticles(0), poolLayout(PoolLayout::Full) {}
+
+    size_t size() const { return x.size(); }
+    bool empty() const { return x.empty(); }
+    size_t capacity() const { return maxParticles; }
+
+    PoolLayout layout() const { return poolLayout; }
+    bool compact() const { return poolLayout != PoolLayout::Full; }
+    bool halfVelocity() const { return poolLayout == PoolLayout::CompactHalf; }
+
+    static const char* layoutName(PoolLayout l) {
+        switch (l) {
+            case PoolLayout::Full: return "Full";
+            case PoolLayout::Compact: return "Compact";
+            case PoolLayout::CompactHalf: return "CompactHalf";
+        }
+        return "";
+    }
+
+    // Bajty na cząstkę w danym układzie (bez rekordów emiterów - najwyżej 256 * 16 B na pulę)
+    static size_t bytesPerParticle(PoolLayout l) {
+        const size_t shared = 3 * sizeof(float) + sizeof(float);                    //Pozycja i wiek
+        const size_t velocity = l == PoolLayout::CompactHalf ? 3 * sizeof(uint16_t) : 3 * sizeof(float);
+        const size_t attributes = l == PoolLayout::Full ? 2 * sizeof(float) + sizeof(ofColor) + sizeof(uint8_t) : sizeof(uint8_t);
+        return shared + velocity + attributes;
+    }
+
+    // Zmienia układ, przepisując żywe cząstki; tablice poprzedniego układu są zwalniane
+    // (alokacja - tylko przy zmianie układu, nie w trakcie symulacji).
+    // Zwraca false i zostawia układ Full, gdy żywe cząstki mają więcej niż 256 różnych rekordów.
+    bool setLayout(PoolLayout newLayout) {
+        if (newLayout == poolLayout) return true;
+        const size_t n = size();
+        const size_t reserved = std::max(maxParticles, n);
+        if (newLayout != PoolLayout::Full && poolLayout == PoolLayout::Full) {
+            emitterRecords.clear();
+            emitterIndex.reserve(reserved);
+            for (size_t i = 0; i < n; ++i) {
+                const size_t r = recordFor(color[i], lifetime[i], invMass[i], flags[i]);
+                if (r == npos) {
+                    release(emitterIndex);
+                    emitterRecords.clear();
+                    return false;
+                }
+                emitterIndex.push_back(uint8_t(r));
+            }
+            release(color);
+            release(lifetime);
+            release(invMass);
+            release(flags);
+        } else if (newLayout == PoolLayout::Full && poolLayout != PoolLayout::Full) {
+            color.reserve(reserved);
+            lifetime.reserve(reserved);
+            invMass.reserve(reserved);
+            flags.reserve(reserved);
+            for (size_t i = 0; i < n; ++i) {
+                const EmitterRecord& r = emitterRecords[emitterIndex[i]];
+                color.push_back(r.color);
+                lifetime.push_back(r.lifetime);
+                invMass.push_back(r.invMass);
+                flags.push_back(r.flags);
+            }
+            release(emitterIndex);
+            emitterRecords.clear();
+        }
+        const SimdKernels::Table& k = SimdKernels::active();
+        if (newLayout == PoolLayout::CompactHalf && poolLayout != PoolLayout::CompactHalf) {
+            hvx.reserve(reserved); hvy.reserve(reserved); hvz.reserve(reserved);
+            hvx.resize(n); hvy.resize(n); hvz.resize(n);
+            k.packHalf(vx.data(), hvx.data(), n);
+            k.packHalf(vy.data(), hvy.data(), n);
+            k.packHalf(vz.data(), hvz.data(), n);
+            release(vx); release(vy); release(vz);
+        } else if (newLayout != PoolLayout::CompactHalf && poolLayout == PoolLayout::CompactHalf) {
+            vx.reserve(reserved); vy.reserve(reserved); vz.reserve(reserved);
+            vx.resize(n); vy.resize(n); vz.resize(n);
+            k.unpackHalf(hvx.data(), vx.data(), n);
+            k.unpackHalf(hvy.data(), vy.data(), n);
+            k.unpackHalf(hvz.data(), vz.data(), n);
+            release(hvx); release(hvy); release(hvz);
+        }
+        poolLayout = newLayout;
+        return true;
+    }
+
+    // Numer rekordu o podanych polach - istniejący albo nowy (emiter woła to raz na emisję, nie na cząstkę).
+    // Przy 256 rekordach nieużywane przez żywe cząstki są zwalniane; gdy wszystkie są w użyciu - npos
+    // (rekord żywych cząstek nigdy nie jest nadpisywany, bo zmieniłby im kolor, czas życia i masę).
+    size_t recordFor(const ofColor& c, float life, float inverseMass, uint8_t particleFlags = 0) {
+        for (size_t r = 0; r < emitterRecords.size(); ++r) {
+            const EmitterRecord& e = emitterRecords[r];
+            if (e.lifetime == life && e.invMass == inverseMass && e.color == c && e.flags == particleFlags) return r;
+        }
+        const EmitterRecord record = { c, life, inverseMass, particleFlags };
+        if (emitterRecords.size() < maxRecords) {
+            emitterRecords.push_back(record);
+            return emitterRecords.size() - 1;
+        }
+        bool used[maxRecords] = {};
+        for (uint8_t r : emitterIndex) used[r] = true;
+        for (size_t r = 0; r < maxRecords; ++r) {
+            if (!used[r]) {
+                emitterRecords[r] = record;
+                return r;
+            }
+        }
+        return npos;
+    }
+
+    // Ustala stałą pojemność puli i od razu alokuje wszystkie tablice.
+    // Po tym wywołaniu spawn()/add() nie alokują pamięci - nadmiarowe cząstki są odrzucane.
+    // Pojemność 0 (domyślnie) oznacza pulę bez limitu, rosnącą jak std::vector.
+    void allocate(size_t capacity) {
+        maxParticles = capacity;
+        reserve(capacity);
+    }
+
+    // Dodaje `count` cząstek na koniec puli (obciętych do pojemności) i zwraca indeks pierwszej.
+    // Pola nowych cząstek wypełnia wywołujący (emiter) bezpośrednio w tablicach.
+    size_t spawn(size_t count) {
+        const size_t first = size();
+        if (maxParticles > 0 && first + count > maxParticles) {
+            count = maxParticles - first;
+        }
+        resize(first + count);
+        return first;
+    }
+
+    // Jak spawn(count), a nowe cząstki od razu dostają wspólne pola emitera (w układzie Compact - numer rekordu).
+    // Gdy nie ma wolnego rekordu, cząstki są odrzucane tak jak nadmiar ponad pojemność.
+    size_t spawn(size_t count, const ofColor& c, float life, float inverseMass, uint8_t particleFlags = 0) {
+        const size_t first = size();
+        const bool full = maxParticles > 0 && first >= maxParticles;
+        if (count == 0 || full) return first;
+        size_t r = 0;
+        if (compact()) {                    //Rekord przed powiększeniem puli - nowe miejsca nie mają jeszcze numeru rekordu
+            r = recordFor(c, life, inverseMass, particleFlags);
+            if (r == npos) return first;
+        }
+        spawn(count);
+        const size_t n = size() - first;
+        if (compact()) {
+            std::fill_n(emitterIndex.data() + first, n, uint8_t(r));
+        } else {
+            std::fill_n(lifetime.data() + first, n, life);
+            std::fill_n(invMass.data() + first, n, inverseMass);
+            std::fill_n(color.data() + first, n, c);
+            std::fill_n(flags.data() + first, n, particleFlags);
+        }
+        return first;
+    }
+
+    void reserve(size_t n) {                //Rezerwuje miejsce w każdej tablicy bieżącego układu
+        x.reserve(n); y.reserve(n); z.reserve(n);
+        age.reserve(n);
+        if (halfVelocity()) {
+            hvx.reserve(n); hvy.reserve(n); hvz.reserve(n);
+        } else {
+            vx.reserve(n); vy.reserve(n); vz.reserve(n);
+        }
+        if (compact()) {
+            emitterIndex.reserve(n);
+        } else {
+            lifetime.reserve(n); invMass.reserve(n);
+            color.reserve(n); flags.reserve(n);
+        }
+    }
+
+    void clear() {
+        x.clear(); y.clear(); z.clear();
+        vx.clear(); vy.clear(); vz.clear();
+        age.clear(); lifetime.clear(); invMass.clear();
+        color.clear(); flags.clear();
+        emitterIndex.clear();
+        hvx.clear(); hvy.clear(); hvz.clear();
+    }
+
+    size_t add(const Particle& p) {         //Dodaje cząstkę na koniec puli i zwraca jej indeks (npos gdy pula pełna albo brak rekordu)
+        const size_t i = spawn(1, p.color, p.lifetime, 1.0f / p.mass, p.flags);
+        if (i == size()) return npos;
+        setPosition(i, p.position);
+        setVelocity(i, p.velocity);
+        age[i] = p.age;
+        return i;
+    }
+
+    void resize(size_t n) {                 //Zmienia liczbę cząstek; przy zmniejszaniu pojemność tablic zostaje
+        x.resize(n); y.resize(n); z.resize(n);
+        age.resize(n);
+        if (halfVelocity()) {
+            hvx.resize(n); hvy.resize(n); hvz.resize(n);
+        } else {
+            vx.resize(n); vy.resize(n); vz.resize(n);
+        }
+        if (compact()) {
+            emitterIndex.resize(n);
+        } else {
+            lifetime.resize(n); invMass.resize(n);
+            color.resize(n); flags.resize(n);
+        }
+    }
+
+    void move(size_t from, size_t to) {     //Kopiuje cząstkę z indeksu `from` na indeks `to`
+        x[to] = x[from]; y[to] = y[from]; z[to] = z[from];
+        age[to] = age[from];
+        if (halfVelocity()) {
+            hvx[to] = hvx[from]; hvy[to] = hvy[from]; hvz[to] = hvz[from];
+        } else {
+            vx[to] = vx[from]; vy[to] = vy[from]; vz[to] = vz[from];
+        }
+        if (compact()) {
+            emitterIndex[to] = emitterIndex[from];
+        } else {
+            lifetime[to] = lifetime[from];
+            invMass[to] = invMass[from];
+            color[to] = color[from];
+            flags[to] = flags[from];
+        }
+    }
+
+    // Usuwa martwe cząstki w jednym liniowym przejściu i zwraca ich liczbę.
+    // Pula jest zawsze ciągła, więc zwolnione miejsca to ogon [size(), capacity()) -
+    // działa on jak lista wolnych slotów: add() zapisuje tam nowe cząstki bez alokacji.
+    size_t reapDead(ReapMode mode = ReapMode::SwapAndPop) {
+        size_t n = size();
+        const size_t before = n;
+        if (mode == ReapMode::SwapAndPop) {
+            for (size_t i = 0; i < n;) {
+                if (isDead(i)) {
+                    --n;
+                    if (i != n) move(n, i);     //Ostatnia cząstka wskakuje w miejsce martwej (kolejność się zmienia)
+                } else {
+                    ++i;
+                }
+            }
+        } else {
+            size_t out = 0;
+            for (size_t i = 0; i < n; ++i) {    //Stabilna kompakcja - żywe cząstki zachowują kolejność
+                if (!isDead(i)) {
+                    if (out != i) move(i, out);
+                    ++out;
+                }
+            }
+            n = out;
+        }
+        resize(n);
+        return before - n;
+    }
+
+    ofVec3f position(size_t i) const { return ofVec3f(x[i], y[i], z[i]); }
+    void setPosition(size_t i, const ofVec3f& p) { x[i] = p.x; y[i] = p.y; z[i] = p.z; }
+
+    ofVec3f velocity(size_t i) const {
+        if (halfVelocity()) {
+            return ofVec3f(SimdKernels::floatFromHalf(hvx[i]), SimdKernels::floatFromHalf(hvy[i]), SimdKernels::floatFromHalf(hvz[i]));
+        }
+        return ofVec3f(vx[i], vy[i], vz[i]);
+    }
+
+    void setVelocity(size_t i, const ofVec3f& v) {
+        if (halfVelocity()) {
+            hvx[i] = SimdKernels::halfFromFloat(v.x); hvy[i] = SimdKernels::halfFromFloat(v.y); hvz[i] = SimdKernels::halfFromFloat(v.z);
+        } else {
+            vx[i] = v.x; vy[i] = v.y; vz[i] = v.z;
+        }
+    }
+
+    void addVelocity(size_t i, float dvx, float dvy, float dvz) {
+        if (halfVelocity()) {
+            setVelocity(i, velocity(i) + ofVec3f(dvx, dvy, dvz));
+        } else {
+            vx[i] += dvx; vy[i] += dvy; vz[i] += dvz;
+        }
+    }
+
+    // Prędkości [first, first + n) jako float (kopia w CompactHalf) i zapis z powrotem
+    void loadVelocity(size_t first, size_t n, float* outX, float* outY, float* outZ) const {
+        const SimdKernels::Table& k = SimdKernels::active();
+        k.unpackHalf(hvx.data() + first, outX, n);
+        k.unpackHalf(hvy.data() + first, outY, n);
+        k.unpackHalf(hvz.data() + first, outZ, n);
+    }
+
+    void storeVelocity(size_t first, size_t n, const float* inX, const float* inY, const float* inZ) {
+        const SimdKernels::Table& k = SimdKernels::active();
+        k.packHalf(inX, hvx.data() + first, n);
+        k.packHalf(inY, hvy.data() + first, n);
+        k.packHalf(inZ, hvz.data() + first, n);
+    }
+
+    // Pola wspólne niezależnie od układu
+    const ofColor& colorAt(size_t i) const { return compact() ? emitterRecords[emitterIndex[i]].color : color[i]; }
+    float lifetimeAt(size_t i) const { return compact() ? emitterRecords[emitterIndex[i]].lifetime : lifetime[i]; }
+    float invMassAt(size_t i) const { return compact() ? emitterRecords[emitterIndex[i]].invMass : invMass[i]; }
+    uint8_t flagsAt(size_t i) const { return compact() ? emitterRecords[emitterIndex[i]].flags : flags[i]; }
+
+    // Odwrotność masy i czas życia [first, first + n) z rekordów (Compact) - dla kerneli czytających tablice
+    void gatherRecords(size_t first, size_t n, float* outInvMass, float* outLifetime) const {
+        const uint8_t* index = emitterIndex.data() + first;
+        const EmitterRecord* records = emitterRecords.data();
+        for (size_t i = 0; i < n; ++i) {
+            const EmitterRecord& r = records[index[i]];
+            outInvMass[i] = r.invMass;
+            outLifetime[i] = r.lifetime;
+        }
+    }
+
+    bool isDead(size_t i) const { return age[i] > lifetimeAt(i); }
+
+    Particle get(size_t i) const {          //Kopia cząstki jako wartość
+        Particle p(position(i), velocity(i), colorAt(i), lifetimeAt(i), 1.0f / invMassAt(i), flagsAt(i));
+        p.age = age[i];
+        return p;
+    }
+
+private:
+    size_t maxParticles;                    //Stała pojemność puli (0 = bez limitu)
+    PoolLayout poolLayout;
+
+    template<class T>
+    static void release(std::vector<T>& v) {    //Zwalnia pamięć tablicy (clear() zostawia pojemność)
+        std::vector<T>().swap(v);
+    }
+};
@@ -0,0 +1,243 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ParticlePool.h"
+#include "ParticleCulling.h"
+
+// Sposób rysowania cząstek
+enum class RenderMode {
+    Immediate,                              //ofSetColor + ofDrawSphere dla każdej cząstki (stary sposób - jedno wywołanie na cząstkę)
+    Instanced,                              //Jedna siatka kuli rysowana instancyjnie dla wszystkich cząstek - jedno wywołanie
+    PointSprites,                           //Punkty skalowane z odległością, wycinane do koła w shaderze - jedno wywołanie
+    Lod                                     //Bez cząstek poza kadrem; blisko kule instancyjne, dalej punkty, sub-piksel zebrany w kafelki ekranu
+};
+
+// Klasa ParticleRenderer - Rysuje całą pulę cząstek
+// W trybach Instanced i PointSprites pozycje i kolory są co klatkę kopiowane do jednego bufora
+// na GPU (ofBufferObject) i rysowane jednym wywołaniem. Wymaga programowalnego renderera (GL 3.2+).
+// W trybie Lod na GPU trafiają tylko cząstki w kadrze: najpierw kule (rysowane instancyjnie),
+// potem punkty, a na końcu jeden punkt zbiorczy na kafelek ekranu z cząstkami mniejszymi niż piksel
+// (w tym samym buforze) - koszt GPU zależy od widocznych pikseli, a nie od liczby cząstek.
+class ParticleRenderer {
+public:
+    RenderMode mode;
+    LodSettings lod;                        //Progi LOD (tryb Lod)
+
+    ParticleRenderer() : mode(RenderMode::Lod), initialized(false), bufferCapacity(0) {}
+
+    static const char* modeName(RenderMode m) {
+        switch (m) {
+            case RenderMode::Immediate: return "Immediate";
+            case RenderMode::Instanced: return "Instanced";
+            case RenderMode::PointSprites: return "PointSprites";
+            case RenderMode::Lod: return "Lod";
+        }
+        return "";
+    }
+
+    void nextMode() {                       //Przełącza tryb (do porównywania czasu klatki)
+        mode = RenderMode((int(mode) + 1) % 4);
+    }
+
+    const LodBuckets& lodBuckets() const { return buckets; }   //Koszyki LOD z ostatniej klatki (tryb Lod)
+
+    // rewind > 0 cofa pozycje o v * rewind (interpolacja między krokami symulacji)
+    void draw(const ParticlePool& pool, float particleRadius, float rewind = 0.0f) {
+        const size_t n = pool.size();
+        if (n == 0) return;
+
+        if (mode == RenderMode::Immediate) {
+            for (size_t i = 0; i < n; ++i) {
+                ofSetColor(pool.colorAt(i));
+                ofDrawSphere(pool.position(i) - pool.velocity(i) * rewind, particleRadius);
+            }
+            return;
+        }
+
+        if (!initialized) setup();
+        if (mode == RenderMode::Lod) {
+            drawLod(pool, particleRadius, rewind);
+            return;
+        }
+        upload(pool, rewind);
+
+        if (mode == RenderMode::Instanced) {
+            instancedShader.begin();
+            instancedShader.setUniform1f("particleRadius", particleRadius);
+            sphereMesh.drawInstanced(OF_MESH_FILL, int(n));
+            instancedShader.end();
+        } else {
+            drawPoints(particleRadius, 0, n);
+        }
+    }
+
+private:
+    static const int instancePositionLocation = 5;
+    static const int instanceColorLocation = 6;
+
+    bool initialized;
+    size_t bufferCapacity;                  //Pojemność buforów na GPU (w cząstkach)
+    std::vector<glm::vec3> positions;       //Bufory pośrednie - alokowane raz, przy zmianie pojemności puli
+    std::vector<ofFloatColor> colors;
+    ofBufferObject positionBuffer;
+    ofBufferObject colorBuffer;
+    ofVboMesh sphereMesh;                   //Kula o promieniu 1, skalowana w shaderze
+    ofVbo pointVbo;
+    ofShader instancedShader;
+    ofShader pointShader;
+    LodBuckets buckets;
+
+    // Punkty z bufora od `first`; skala rzutowania: ile pikseli ma obiekt o rozmiarze 1 w odległości 1 od kamery
+    // tileSize > 0: kwadratowe punkty zbiorcze o tym boku w pikselach, przezroczystość już w kolorze
+    void drawPoints(float particleRadius, size_t first, size_t count, float tileSize = 0.0f) {
+        float pointScale = ofGetCurrentMatrix(OF_MATRIX_PROJECTION)[1][1] * ofGetViewportHeight() * 0.5f;
+        glEnable(GL_PROGRAM_POINT_SIZE);
+        pointShader.begin();
+        pointShader.setUniform1f("particleRadius", particleRadius);
+        pointShader.setUniform1f("pointScale", pointScale);
+        pointShader.setUniform1f("tileSize", tileSize);
+        pointVbo.draw(GL_POINTS, int(first), int(count));
+        pointShader.end();
+        glDisable(GL_PROGRAM_POINT_SIZE);
+    }
+
+    void drawLod(const ParticlePool& pool, float particleRadius, float rewind) {
+        ParticleCulling::classify(pool, particleRadius, rewind, CullingView::fromCurrentMatrices(), lod, buckets);
+        const size_t meshes = buckets.meshes.size();
+        const size_t sprites = buckets.sprites.size();
+        const size_t aggregates = buckets.aggregates.size();
+        if (meshes + sprites + aggregates == 0) return;
+
+        reserveBuffers(pool);
+        for (size_t k = 0; k < meshes; ++k) {                 //Kule na początku bufora, punkty za nimi
+            stage(pool, buckets.meshes[k], k, rewind);
+        }
+        for (size_t k = 0; k < sprites; ++k) {
+            stage(pool, buckets.sprites[k], meshes + k, rewind);
+        }
+        for (size_t k = 0; k < aggregates; ++k) {              //Punkty zbiorcze za punktami (mniej niż cząstek sub-pikselowych)
+            const LodAggregate& a = buckets.aggregates[k];
+            positions[meshes + sprites + k] = glm::vec3(a.x, a.y, a.z);
+            colors[meshes + sprites + k] = ofFloatColor(a.r, a.g, a.b, a.a);
+        }
+        const size_t items = meshes + sprites + aggregates;
+        positionBuffer.updateData(0, items * sizeof(glm::vec3), positions.data());
+        colorBuffer.updateData(0, items * sizeof(ofFloatColor), colors.data());
+
+        if (meshes > 0) {
+            instancedShader.begin();
+            instancedShader.setUniform1f("particleRadius", particleRadius);
+            sphereMesh.drawInstanced(OF_MESH_FILL, int(meshes));
+            instancedShader.end();
+        }
+        if (sprites > 0) {
+            drawPoints(particleRadius, meshes, sprites);
+        }
+        if (aggregates > 0) {
+            drawPoints(particleRadius, meshes + sprites, aggregates, float(std::max(lod.aggregateTile, 1)));
+        }
+    }
+
+    void stage(const ParticlePool& pool, size_t i, size_t slot, float rewind) {
+        const ofVec3f v = pool.velocity(i);
+        positions[slot] = glm::vec3(pool.x[i] - v.x * rewind, pool.y[i] - v.y * rewind, pool.z[i] - v.z * rewind);
+        colors[slot] = pool.colorAt(i);
+    }
+
+    void setup() {
+        sphereMesh = ofMesh::sphere(1.0f, 12);
+
+        instancedShader.setupShaderFromSource(GL_VERTEX_SHADER, R"(
+            #version 150
+            uniform mat4 modelViewProjectionMatrix;
+            uniform float particleRadius;
+            in vec4 position;
+            in vec3 instancePosition;
+            in vec4 instanceColor;
+            out vec4 vColor;
+            void main() {
+                vColor = instanceColor;
+                gl_Position = modelViewProjectionMatrix * vec4(position.xyz * particleRadius + instancePosition, 1.0);
+            }
+        )");
+        instancedShader.setupShaderFromSource(GL_FRAGMENT_SHADER, R"(
+            #version 150
+            in vec4 vColor;
+            out vec4 fragColor;
+            void main() {
+                fragColor = vColor;
+            }
+        )");
+        instancedShader.bindDefaults();
+        instancedShader.bindAttribute(instancePositionLocation, "instancePosition");
+        instancedShader.bindAttribute(instanceColorLocation, "instanceColor");
+        instancedShader.linkProgram();
+
+        pointShader.setupShaderFromSource(GL_VERTEX_SHADER, R"(
+            #version 150
+            uniform mat4 modelViewProjectionMatrix;
+            uniform float particleRadius;
+            uniform float pointScale;
+            uniform float tileSize;
+            in vec4 position;
+            in vec4 color;
+            out vec4 vColor;
+            void main() {
+                gl_Position = modelViewProjectionMatrix * position;
+                if (tileSize > 0.0) {                  // Punkt zbiorczy - kafelek ekranu z pokryciem w kolorze
+                    gl_PointSize = tileSize;
+                    vColor = color;
+                    return;
+                }
+                float size = 2.0 * particleRadius * pointScale / gl_Position.w;
+                gl_PointSize = max(1.0, size);
+                vColor = vec4(color.rgb, color.a * min(1.0, size * size));   // Cząstka mniejsza niż piksel - przezroczystość wg pokrycia
+            }
+        )");
+        pointShader.setupShaderFromSource(GL_FRAGMENT_SHADER, R"(
+            #version 150
+            uniform float tileSize;
+            in vec4 vColor;
+            out vec4 fragColor;
+            void main() {
+                vec2 p = gl_PointCoord * 2.0 - 1.0;
+                if (tileSize <= 0.0 && dot(p, p) > 1.0) discard;   // Kwadratowy punkt -> koło (kafelek zostaje kwadratem)
+                fragColor = vColor;
+            }
+        )");
+        pointShader.bindDefaults();
+        pointShader.linkProgram();
+
+        initialized = true;
+    }
+
+    void upload(const ParticlePool& pool, float rewind) {
+        const size_t n = pool.size();
+        reserveBuffers(pool);
+        for (size_t i = 0; i < n; ++i) {
+            stage(pool, i, i, rewind);
+        }
+        positionBuffer.updateData(0, n * sizeof(glm::vec3), positions.data());
+        colorBuffer.updateData(0, n * sizeof(ofFloatColor), colors.data());
+    }
+
+    void reserveBuffers(const ParticlePool& pool) {
+        const size_t n = pool.size();
+        if (n > bufferCapacity) {           //Realokacja tylko gdy pula urosła (przy stałej pojemności puli - raz)
+            bufferCapacity = std::max(n, pool.capacity());
+            positions.resize(bufferCapacity);
+            colors.resize(bufferCapacity);
+            positionBuffer.allocate(bufferCapacity * sizeof(glm::vec3), GL_DYNAMIC_DRAW);
+            colorBuffer.allocate(bufferCapacity * sizeof(ofFloatColor), GL_DYNAMIC_DRAW);
+
+            ofVbo& sphereVbo = sphereMesh.getVbo();
+            sphereVbo.setAttributeBuffer(instancePositionLocation, positionBuffer, 3, sizeof(glm::vec3));
+            sphereVbo.setAttributeDivisor(instancePositionLocation, 1);
+            sphereVbo.setAttributeBuffer(instanceColorLocation, colorBuffer, 4, sizeof(ofFloatColor));
+            sphereVbo.setAttributeDivisor(instanceColorLocation, 1);
+
+            pointVbo.setVertexBuffer(positionBuffer, 3, sizeof(glm::vec3));
+            pointVbo.setColorBuffer(colorBuffer, sizeof(ofFloatColor));
+        }
+    }
+};
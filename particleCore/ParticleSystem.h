@@ -0,0 +1,229 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ParticlePool.h"
+#include "ParticleRenderer.h"
+#include "JobSystem.h"
+#include "SimdKernels.h"
+#include "SphereColliderSet.h"
+#include "ParticleInteractions.h"
+#include "ForceFields.h"
+#include "FrameProfiler.h"
+#include "GroundAccumulation.h"
+
+// Klasa ParticleSystem - Reprezentuje cały system cząsteczek
+// EmitterType to dowolny emiter z metodami `void emit(float dt, ParticlePool& pool)` i `size_t estimateCapacity() const`
+// (Emitter, EmitterSnow, dowolny ShapeEmitter albo EmitterSet z wieloma emiterami)
+template<class EmitterType>
+class ParticleSystem {
+public:
+    ParticlePool particles;                     //Pula cząstek (struct-of-arrays)
+    EmitterType emitter;                        //Emiter generujący nowe cząsteczki
+
+    ofVec3f spherePosition;                     // Położenie i promień kuli - promień 0 wyłącza kulę
+    float sphereRadius;
+    SphereColliderSet colliders;                // Dodatkowe kule do kolizji (dowolnie wiele, z siatką)
+    ParticleInteractions interactions;          // Oddziaływania cząstka-cząstka (domyślnie wyłączone)
+    ForceFieldStack forces;                     // Pola sił (grawitacja, opór, przyciąganie, wiry, turbulencja)
+    GroundAccumulation ground;                  // Ziemia zbierająca opadłe płatki (domyślnie wyłączona - ground.setup)
+    float particleRadius;                       // Promień rysowanej cząstki
+    ReapMode reapMode;                          // Sposób usuwania martwych cząstek
+    mutable ParticleRenderer renderer;          // Rysowanie cząstek (tryb: renderer.mode)
+
+    // Konstruktor uwzględniający emiter (kula domyślnie wyłączona)
+    // Pula jest alokowana raz; pojemność 0 oznacza oszacowanie z emitera (szybkość emisji * czas życia z zapasem)
+    ParticleSystem(const EmitterType& em, size_t capacity = 0)
+        : emitter(em), spherePosition(ofVec3f(0, 0, 0)), sphereRadius(0.0f), particleRadius(3.0f),
+          reapMode(ReapMode::SwapAndPop), pendingForce(0, 0, 0), deadCount(0), groundBatchCount(0), stepIndex(0), drawIndex(0) {
+        if (capacity == 0) {
+            capacity = estimateCapacity(em);
+        }
+        particles.allocate(capacity);
+    }
+
+    // Maksymalna liczba żywych cząstek - szacuje emiter (ShapeEmitter, EmitterSet)
+    static size_t estimateCapacity(const EmitterType& em) {
+        return em.estimateCapacity();
+    }
+
+    // Liczba wątków aktualizacji (łącznie z głównym); 1 = aktualizacja szeregowa, 0 = wszystkie rdzenie
+    // Wynik jest identyczny bit w bit niezależnie od liczby wątków - każda cząstka liczona jest tym samym kodem.
+    void setThreadCount(unsigned threads) {
+        if (threads == 1) {
+            jobs.reset();
+        } else {
+            jobs.reset(new JobSystem(threads));
+        }
+    }
+
+    unsigned threadCount() const { return jobs ? jobs->threadCount() : 1; }
+
+    // Funkcja dodajaca siłe do cząsteczek
+    // Siła jest zapamiętywana i dodawana w update() w tym samym przejściu co ruch i kolizje -
+    // działa na cząstki istniejące przed emisją, tak jak gdyby była dodana od razu.
+    // Zmiana prędkości to force * invMass * dt, więc wynik nie zależy od liczby klatek na sekundę.
+    void applyForce(const ofVec3f& force) {
+        pendingForce += force;
+    }
+
+    // Etapy są mierzone przez FrameProfiler (gdy włączony); w przejściu równoległym - osobno dla każdego kawałka
+    void update(float dt) {
+        step(dt, true);
+    }
+
+    // Uproszczony krok bez oddziaływań cząstka-cząstka (zwykle z dłuższym dt) - dla odległych kawałków ChunkedWorld.
+    // Siły, pola sił i kolizje działają jak w update(), więc śnieg dalej opada i dryfuje z wiatrem.
+    void updateCoarse(float dt) {
+        step(dt, false);
+    }
+
+    void draw() const {
+        draw(particles, 0.0f);
+    }
+
+    // Rysuje podany stan puli (np. kopię z FixedStepScheduler), z pozycjami cofniętymi o v * rewind
+    void draw(const ParticlePool& state, float rewind) const {
+        if (sphereRadius > 0) {
+            ofSetColor(100, 100, 255);
+            ofDrawSphere(spherePosition, sphereRadius);     // Rysowanie kuli
+        }
+        for (size_t i = 0; i < colliders.size(); ++i) {     // Rysowanie pozostałych kul
+            ofSetColor(100, 100, 255);
+            ofDrawSphere(colliders[i].center, colliders[i].radius);
+        }
+
+        ProfileScope scope(ProfileStage::Draw, ++drawIndex);
+        ground.draw();                                      //Ziemia ze śniegiem (gdy włączona)
+        renderer.draw(state, particleRadius, rewind);       //Rysowanie cząsteczek
+    }
+
+private:
+    static const size_t chunkSize = 4096;       // Minimalny kawałek puli dla jednego zadania
+    static const size_t compactBlock = 512;     // Blok rozpakowanych pól w układzie Compact (10 KB na stosie, w L1)
+
+    ofVec3f pendingForce;                       // Suma sił z applyForce od ostatniego update
+    std::unique_ptr<JobSystem> jobs;            // Pula wątków (brak = aktualizacja szeregowa)
+    std::atomic<size_t> deadCount;              // Liczba cząstek oznaczonych jako martwe w bieżącej klatce
+    std::vector<GroundBatch> groundBatches;     // Osiadłe cząstki z każdego zakresu przejścia równoległego (bufory używane ponownie)
+    std::atomic<size_t> groundBatchCount;       // Zajęte paczki w bieżącym kroku
+    uint32_t stepIndex;                         // Numer kroku i klatki rysowania dla FrameProfiler
+    mutable uint32_t drawIndex;
+
+    // Wspólny krok update() i updateCoarse()
+    void step(float dt, bool withInteractions) {
+        const uint32_t frame = ++stepIndex;
+        ProfileScope updateScope(ProfileStage::Update, frame);
+        const size_t forcedCount = particles.size();        //Cząstki, na które działa siła z applyForce
+        {
+            ProfileScope scope(ProfileStage::Emit, frame);
+            emitter.emit(dt, particles);                    //Emiter zapisuje nowe cząstki bezpośrednio w puli
+        }
+
+        if (colliders.needsRebuild()) {
+            ProfileScope scope(ProfileStage::Collide, frame);
+            colliders.rebuild();                            //Siatka kul po dodaniu lub przesunięciu kul
+        }
+        if (withInteractions && interactions.enabled()) {
+            ProfileScope scope(ProfileStage::Interactions, frame);
+            interactions.apply(particles, dt, jobs.get());  //Sąsiedzi z haszowanej siatki
+        }
+        forces.time += dt;                                  //Czas pól zmiennych w czasie (turbulencja)
+
+        deadCount.store(0, std::memory_order_relaxed);
+        const bool settle = ground.enabled();
+        if (settle) {
+            const size_t ranges = particles.size() / chunkSize + 1;     //Zakres parallelFor ma co najmniej chunkSize cząstek
+            if (groundBatches.size() < ranges) groundBatches.resize(ranges);
+            groundBatchCount.store(0, std::memory_order_relaxed);
+        }
+        auto kernel = [&](size_t begin, size_t end) {
+            simulateRange(begin, end, forcedCount, dt);
+            if (settle) {                                   //Test ziemi na kawałku jeszcze w cache
+                ProfileScope scope(ProfileStage::Collide, frame);
+                GroundBatch& batch = groundBatches[groundBatchCount.fetch_add(1, std::memory_order_relaxed)];
+                deadCount.fetch_add(ground.collect(particles, begin, end, batch), std::memory_order_relaxed);
+            }
+        };
+        if (jobs) {
+            jobs->parallelFor(particles.size(), chunkSize, kernel);     //Kawałki puli na wszystkich rdzeniach
+        } else {
+            kernel(0, particles.size());
+        }
+        pendingForce.set(0, 0, 0);
+        if (settle) {
+            ProfileScope scope(ProfileStage::Collide, frame);
+            ground.deposit(particles, groundBatches.data(), groundBatchCount.load(std::memory_order_relaxed));   //Szeregowo tylko osiadłe płatki
+        }
+
+        if (deadCount.load(std::memory_order_relaxed) > 0) {
+            ProfileScope scope(ProfileStage::Reap, frame);
+            particles.reapDead(reapMode);                   // Usuwa martwe cząstki w jednym przejściu
+        }
+    }
+
+    // Jedno przejście po zakresie puli: siła, pola sił, ruch, wiek, kolizje z kulami i zliczanie martwych cząstek
+    // Kernele wektorowe (SimdKernels) przechodzą po kawałku puli jeden po drugim - kawałek mieści się w L2.
+    void simulateRange(size_t begin, size_t end, size_t forcedCount, float dt) {
+        ParticlePool& p = particles;
+        if (!p.compact()) {
+            simulateBlock(begin, end, forcedCount, dt, p.vx.data() + begin, p.vy.data() + begin, p.vz.data() + begin,
+                          p.invMass.data() + begin, p.lifetime.data() + begin);
+            return;
+        }
+        // Compact: odwrotność masy i czas życia z rekordów emiterów (a w CompactHalf także prędkość)
+        // rozpakowane do bloku na stosie - te same kernele, ten sam wynik co w układzie Full dla tych samych danych
+        float invMass[compactBlock], lifetime[compactBlock];
+        float vx[compactBlock], vy[compactBlock], vz[compactBlock];
+        const bool half = p.halfVelocity();
+        for (size_t b = begin; b < end; b += compactBlock) {
+            const size_t n = std::min(compactBlock, end - b);
+            p.gatherRecords(b, n, invMass, lifetime);
+            if (half) {
+                p.loadVelocity(b, n, vx, vy, vz);
+                simulateBlock(b, b + n, forcedCount, dt, vx, vy, vz, invMass, lifetime);
+                p.storeVelocity(b, n, vx, vy, vz);
+            } else {
+                simulateBlock(b, b + n, forcedCount, dt, p.vx.data() + b, p.vy.data() + b, p.vz.data() + b, invMass, lifetime);
+            }
+        }
+    }
+
+    // Kernele dla cząstek [begin, end); prędkość, odwrotność masy i czas życia wskazują na element `begin`
+    void simulateBlock(size_t begin, size_t end, size_t forcedCount, float dt,
+                       float* vx, float* vy, float* vz, const float* invMass, const float* lifetime) {
+        const SimdKernels::Table& k = SimdKernels::active();
+        ParticlePool& p = particles;
+        float* x = p.x.data() + begin;
+        float* y = p.y.data() + begin;
+        float* z = p.z.data() + begin;
+        const size_t n = end - begin;
+
+        const uint32_t frame = stepIndex;
+        {
+            ProfileScope scope(ProfileStage::Forces, frame);
+            size_t forcedEnd = std::min(std::max(begin, forcedCount), end);
+            if (forcedEnd > begin) {                        //Siła tylko dla cząstek sprzed emisji
+                k.applyForce(vx, vy, vz, invMass, forcedEnd - begin,
+                             pendingForce.x * dt, pendingForce.y * dt, pendingForce.z * dt);
+            }
+            if (!forces.empty()) {                          //Wszystkie pola sił w jednym przejściu po kawałku
+                forces.apply(x, y, z, vx, vy, vz, invMass, n, dt);
+            }
+        }
+        {
+            ProfileScope scope(ProfileStage::Integrate, frame);
+            k.integrate(x, y, z, vx, vy, vz, p.age.data() + begin, n, dt);     //Aktualizacja pozycji i wieku cząsteczek
+        }
+        if (sphereRadius > 0 || !colliders.empty()) {
+            ProfileScope scope(ProfileStage::Collide, frame);
+            if (sphereRadius > 0) {                         // Obsługa kolizji z kulą (ruch z całego kroku - bez przelatywania)
+                k.collideSphere(x, y, z, vx, vy, vz, n, spherePosition.x, spherePosition.y, spherePosition.z, sphereRadius, dt);
+            }
+            if (!colliders.empty()) {                       // Kolizje z pozostałymi kulami
+                colliders.collide(x, y, z, vx, vy, vz, n, dt);
+            }
+        }
+        ProfileScope scope(ProfileStage::Reap, frame);
+        deadCount.fetch_add(k.countDead(p.age.data() + begin, lifetime, n), std::memory_order_relaxed);
+    }
+};
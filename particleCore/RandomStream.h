@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Klasa RandomStream - Szybki, powtarzalny generator liczb losowych (xoshiro128+)
+// Zamiast jednego globalnego stanu (ofRandom) każdy emiter, a w razie potrzeby każdy wątek,
+// ma własny strumień: RandomStream(ziarno, numer strumienia). Ten sam seed daje zawsze te same liczby.
+// Generator ma 8 niezależnych torów (stany trzymane jako tablice), które krok wykonują razem -
+// pętla w fill() to proste operacje na uint32, które kompilator zamienia na instrukcje wektorowe.
+class RandomStream {
+public:
+    static const int lanes = 8;
+
+    explicit RandomStream(uint64_t seedValue = 0, uint64_t stream = 0) {
+        seed(seedValue, stream);
+    }
+
+    // Stan wszystkich torów z splitmix64 - różne strumienie dają niezależne ciągi dla tego samego ziarna
+    void seed(uint64_t seedValue, uint64_t stream = 0) {
+        uint64_t sm = seedValue ^ (stream * 0xD1B54A32D192ED03ull);
+        for (int k = 0; k < 4; ++k) {
+            for (int l = 0; l < lanes; ++l) {
+                s[k][l] = uint32_t(splitmix64(sm) >> 32);
+            }
+        }
+        for (int l = 0; l < lanes; ++l) {           //Stan z samych zer nie wychodzi z zera
+            if ((s[0][l] | s[1][l] | s[2][l] | s[3][l]) == 0) s[0][l] = 1;
+        }
+        bufferPos = lanes;
+    }
+
+    // Liczba z przedziału [0, 1)
+    float nextFloat() {
+        if (bufferPos == lanes) {
+            step(buffer);
+            bufferPos = 0;
+        }
+        return toFloat(buffer[bufferPos++]);
+    }
+
+    // Liczba z przedziału [lo, hi)
+    float uniform(float lo, float hi) {
+        return lo + (hi - lo) * nextFloat();
+    }
+
+    // Wypełnia out[0..n) liczbami z przedziału [lo, hi) - po 8 na raz, reszta pojedynczo
+    void fill(float* out, size_t n, float lo, float hi) {
+        const float range = hi - lo;
+        size_t i = 0;
+        for (; i + lanes <= n; i += lanes) {
+            uint32_t r[lanes];
+            step(r);
+            for (int l = 0; l < lanes; ++l) {
+                out[i + l] = lo + range * toFloat(r[l]);
+            }
+        }
+        for (; i < n; ++i) {
+            out[i] = lo + range * nextFloat();
+        }
+    }
+
+private:
+    uint32_t s[4][lanes];                   //Stan xoshiro128+ dla każdego toru
+    uint32_t buffer[lanes];                 //Wynik ostatniego kroku dla pojedynczych liczb
+    int bufferPos;
+
+    static uint64_t splitmix64(uint64_t& x) {
+        uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    static float toFloat(uint32_t r) {
+        return float(r >> 8) * (1.0f / 16777216.0f);   //Górne 24 bity - dokładnie reprezentowalne we float
+    }
+
+    void step(uint32_t out[lanes]) {
+        for (int l = 0; l < lanes; ++l) {
+            out[l] = s[0][l] + s[3][l];
+            uint32_t t = s[1][l] << 9;
+            s[2][l] ^= s[0][l];
+            s[3][l] ^= s[1][l];
+            s[1][l] ^= s[2][l];
+            s[0][l] ^= s[3][l];
+            s[2][l] ^= t;
+            s[3][l] = (s[3][l] << 11) | (s[3][l] >> 21);
+        }
+    }
+};
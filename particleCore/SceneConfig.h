@@ -0,0 +1,409 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ParticleSystem.h"
+#include "Emitter.h"
+#include "EmitterSet.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+// Konfiguracja sceny z pliku JSON (bin/data/scene.json) - bez przebudowy aplikacji
+// Wszystkie klucze są opcjonalne; brakujący klucz zostawia bieżącą wartość (domyślne w Scenes.h).
+// {
+//   "particleRadius": 3,
+//   "layout": "Compact",                                            układ puli: Full, Compact albo CompactHalf
+//   "wind": [120, 120, 0],                                          siła dodawana co krok (applyForce)
+//   "sphere": { "position": [0, 0, 0], "radius": 100 },             promień 0 wyłącza kulę
+//   "interactions": { "mode": "Clumping", "radius": 6, "strength": 20 },
+//   "ground": { "position": [0, -250, 0], "size": 3200, "resolution": 96, "hills": 40, "depthPerParticle": 2, "maxDepth": 150,
+//               "color": [255, 255, 255] },                       resolution 0 wyłącza ziemię; color - kolor warstwy śniegu
+//   "forces": [ { "type": "drag", "linear": 0.5 }, { "type": "curlNoise", "strength": 40, "frequency": 0.004, "timeScale": 0.3 } ],
+//   "emitters": [ { "shape": "point", "position": [-300, -250, 0], "velocity": [0, 0, 0], "velocityRange": [100, 100, 100],
+//                   "color": [200, 0, 40], "lifetime": 3, "rate": 1000, "mass": 1, "seed": 1, "settles": false } ]
+// }                                                                 settles: cząstki emitera osiadają na ziemi jako śnieg
+// Kształty emiterów: point (position), box (position, range - połowa boku), sphere (position, radius, surface),
+// disc (position, normal, radius). Pola sił: gravity (acceleration), drag (linear, quadratic),
+// attractor (position, strength, radius), vortex (position, axis, strength, radius), curlNoise (strength, frequency, timeScale).
+namespace SceneConfig {
+
+    inline bool read(const ofJson& j, const char* key, float& out) {
+        auto it = j.find(key);
+        if (it == j.end()) return false;
+        if (!it->is_number()) {
+            ofLogWarning("SceneConfig") << key << ": oczekiwana liczba";
+            return false;
+        }
+        out = it->get<float>();
+        return true;
+    }
+
+    inline bool read(const ofJson& j, const char* key, bool& out) {
+        auto it = j.find(key);
+        if (it == j.end()) return false;
+        if (!it->is_boolean()) {
+            ofLogWarning("SceneConfig") << key << ": oczekiwane true/false";
+            return false;
+        }
+        out = it->get<bool>();
+        return true;
+    }
+
+    inline bool read(const ofJson& j, const char* key, uint64_t& out) {
+        auto it = j.find(key);
+        if (it == j.end()) return false;
+        if (!it->is_number_unsigned()) {
+            ofLogWarning("SceneConfig") << key << ": oczekiwana liczba calkowita >= 0";
+            return false;
+        }
+        out = it->get<uint64_t>();
+        return true;
+    }
+
+    inline bool read(const ofJson& j, const char* key, std::string& out) {
+        auto it = j.find(key);
+        if (it == j.end()) return false;
+        if (!it->is_string()) {
+            ofLogWarning("SceneConfig") << key << ": oczekiwany tekst";
+            return false;
+        }
+        out = it->get<std::string>();
+        return true;
+    }
+
+    // Wektor jako [x, y, z]
+    inline bool read(const ofJson& j, const char* key, ofVec3f& out) {
+        auto it = j.find(key);
+        if (it == j.end()) return false;
+        if (!it->is_array() || it->size() != 3 || !(*it)[0].is_number() || !(*it)[1].is_number() || !(*it)[2].is_number()) {
+            ofLogWarning("SceneConfig") << key << ": oczekiwane [x, y, z]";
+            return false;
+        }
+        out.set((*it)[0].get<float>(), (*it)[1].get<float>(), (*it)[2].get<float>());
+        return true;
+    }
+
+    // Kolor jako [r, g, b] albo [r, g, b, a], składowe 0-255
+    inline bool read(const ofJson& j, const char* key, ofColor& out) {
+        auto it = j.find(key);
+        if (it == j.end()) return false;
+        bool valid = it->is_array() && (it->size() == 3 || it->size() == 4);
+        for (size_t k = 0; valid && k < it->size(); ++k) {
+            valid = (*it)[k].is_number() && (*it)[k].get<float>() >= 0 && (*it)[k].get<float>() <= 255;
+        }
+        if (!valid) {
+            ofLogWarning("SceneConfig") << key << ": oczekiwane [r, g, b] albo [r, g, b, a] (0-255)";
+            return false;
+        }
+        out = ofColor((*it)[0].get<int>(), (*it)[1].get<int>(), (*it)[2].get<int>(), it->size() == 4 ? (*it)[3].get<int>() : 255);
+        return true;
+    }
+
+    // Parametry kształtu - nazwa kształtu w pliku to "shape"
+    inline const char* shapeName(const PointShape&) { return "point"; }
+    inline const char* shapeName(const BoxShape&) { return "box"; }
+    inline const char* shapeName(const SphereShape&) { return "sphere"; }
+    inline const char* shapeName(const DiscShape&) { return "disc"; }
+
+    inline void applyShape(PointShape& s, const ofJson& j) {
+        read(j, "position", s.center);
+    }
+
+    inline void applyShape(BoxShape& s, const ofJson& j) {
+        read(j, "position", s.center);
+        read(j, "range", s.halfExtent);
+    }
+
+    inline void applyShape(SphereShape& s, const ofJson& j) {
+        read(j, "position", s.center);
+        read(j, "radius", s.radius);
+        read(j, "surface", s.surface);
+    }
+
+    inline void applyShape(DiscShape& s, const ofJson& j) {
+        read(j, "position", s.center);
+        read(j, "normal", s.normal);
+        read(j, "radius", s.radius);
+    }
+
+    // Zmienia działający emiter w miejscu. Ziarno ("seed") jest brane tylko przy tworzeniu emitera
+    // (reseed = true) - przeładowanie pliku nie zaczyna losowania od nowa.
+    template<class Shape>
+    void applyEmitter(ShapeEmitter<Shape>& e, const ofJson& j, bool reseed) {
+        applyShape(e.shape, j);
+        read(j, "velocity", e.velocity);
+        read(j, "velocityRange", e.velocityRange);
+        read(j, "color", e.color);
+        float value;
+        if (read(j, "lifetime", value) && value > 0) e.lifetime = value;
+        if (read(j, "rate", value) && value >= 0) e.emissionRate = value;
+        if (read(j, "mass", value) && value > 0) e.mass = value;
+        read(j, "settles", e.settles);
+        uint64_t seed;
+        if (reseed && read(j, "seed", seed)) {
+            e.random.seed(seed);
+            e.timeSinceLastEmit = 0;
+        }
+    }
+
+    inline std::string shapeOf(const ofJson& j) {
+        std::string shape = "point";
+        read(j, "shape", shape);
+        return shape;
+    }
+
+    // Nowy emiter z opisu w pliku; false przy nieznanym kształcie
+    inline bool addEmitter(EmitterSet& set, const ofJson& j) {
+        const std::string shape = shapeOf(j);
+        const ofVec3f zero(0, 0, 0);
+        if (shape == "point") {
+            applyEmitter(set.add(ShapeEmitter<PointShape>(PointShape(), zero, zero, ofColor(255, 255, 255), 1.0f, 0, 1.0f)), j, true);
+        } else if (shape == "box") {
+            applyEmitter(set.add(ShapeEmitter<BoxShape>(BoxShape(zero, zero), zero, zero, ofColor(255, 255, 255), 1.0f, 0, 1.0f)), j, true);
+        } else if (shape == "sphere") {
+            applyEmitter(set.add(ShapeEmitter<SphereShape>(SphereShape(zero, 0), zero, zero, ofColor(255, 255, 255), 1.0f, 0, 1.0f)), j, true);
+        } else if (shape == "disc") {
+            applyEmitter(set.add(ShapeEmitter<DiscShape>(DiscShape(zero, ofVec3f(0, 1, 0), 0), zero, zero, ofColor(255, 255, 255), 1.0f, 0, 1.0f)), j, true);
+        } else {
+            ofLogWarning("SceneConfig") << "Nieznany ksztalt emitera: " << shape;
+            return false;
+        }
+        return true;
+    }
+
+    // Ten sam kształt co w pliku - zmiana w miejscu (dynamic_cast raz na emiter przy przeładowaniu)
+    template<class Shape>
+    bool applyIfShape(EmitterBase& e, const ofJson& j, bool reseed) {
+        ShapeEmitter<Shape>* typed = dynamic_cast<ShapeEmitter<Shape>*>(&e);
+        if (!typed || shapeOf(j) != shapeName(typed->shape)) return false;
+        applyEmitter(*typed, j, reseed);
+        return true;
+    }
+
+    // Pojedynczy emiter (myParticleSystem) - pierwszy opis z listy, kształt musi się zgadzać z typem
+    template<class Shape>
+    void applyEmitters(ShapeEmitter<Shape>& e, const ofJson& list, bool reseed) {
+        if (list.empty()) return;
+        if (shapeOf(list[0]) != shapeName(e.shape)) {
+            ofLogWarning("SceneConfig") << "Emiter tej aplikacji ma ksztalt " << shapeName(e.shape);
+            return;
+        }
+        applyEmitter(e, list[0], reseed);
+    }
+
+    // Zestaw emiterów (animacjaSwiateczna) - ta sama lista kształtów: zmiana w miejscu (emitery losują dalej);
+    // inna liczba albo kolejność kształtów: zestaw budowany od nowa z ziarnami z pliku
+    inline void applyEmitters(EmitterSet& set, const ofJson& list, bool reseed) {
+        bool sameLayout = !reseed && set.size() == list.size();
+        for (size_t i = 0; sameLayout && i < set.size(); ++i) {
+            sameLayout = applyIfShape<PointShape>(set[i], list[i], false) || applyIfShape<BoxShape>(set[i], list[i], false)
+                      || applyIfShape<SphereShape>(set[i], list[i], false) || applyIfShape<DiscShape>(set[i], list[i], false);
+        }
+        if (sameLayout) return;
+        EmitterSet rebuilt;
+        for (const ofJson& j : list) {
+            if (j.is_object()) addEmitter(rebuilt, j);
+        }
+        set = std::move(rebuilt);
+    }
+
+    inline bool interactionMode(const std::string& name, InteractionMode& out) {
+        const InteractionMode modes[] = { InteractionMode::None, InteractionMode::Repulsion, InteractionMode::Clumping, InteractionMode::Density };
+        for (InteractionMode m : modes) {
+            if (name == ParticleInteractions::modeName(m)) {
+                out = m;
+                return true;
+            }
+        }
+        ofLogWarning("SceneConfig") << "Nieznany tryb oddzialywan: " << name;
+        return false;
+    }
+
+    inline bool poolLayout(const std::string& name, PoolLayout& out) {
+        const PoolLayout layouts[] = { PoolLayout::Full, PoolLayout::Compact, PoolLayout::CompactHalf };
+        for (PoolLayout l : layouts) {
+            if (name == ParticlePool::layoutName(l)) {
+                out = l;
+                return true;
+            }
+        }
+        ofLogWarning("SceneConfig") << "Nieznany uklad puli: " << name;
+        return false;
+    }
+
+    // Lista pól sił zastępuje bieżącą; czas pól (CurlNoise) płynie dalej
+    inline void applyForces(ForceFieldStack& forces, const ofJson& list) {
+        forces.clear();
+        for (const ofJson& f : list) {
+            std::string type;
+            if (!f.is_object() || !read(f, "type", type)) continue;
+            ofVec3f point(0, 0, 0), axis(0, 1, 0);
+            float strength = 0, radius = 0, linear = 0, quadratic = 0, frequency = 0.01f, timeScale = 0;
+            read(f, "strength", strength);
+            read(f, "radius", radius);
+            if (type == "gravity") {
+                read(f, "acceleration", point);
+                forces.addGravity(point);
+            } else if (type == "drag") {
+                read(f, "linear", linear);
+                read(f, "quadratic", quadratic);
+                forces.addDrag(linear, quadratic);
+            } else if (type == "attractor") {
+                read(f, "position", point);
+                forces.addAttractor(point, strength, radius);
+            } else if (type == "vortex") {
+                read(f, "position", point);
+                read(f, "axis", axis);
+                forces.addVortex(point, axis, strength, radius);
+            } else if (type == "curlNoise") {
+                read(f, "frequency", frequency);
+                read(f, "timeScale", timeScale);
+                forces.addCurlNoise(strength, frequency, timeScale);
+            } else {
+                ofLogWarning("SceneConfig") << "Nieznane pole sil: " << type;
+            }
+        }
+    }
+
+    // Ziemia zbierająca śnieg; nowa siatka (bez śniegu) tylko wtedy, gdy zmienia się jej położenie, bok, węzły albo pagórki
+    inline void applyGround(GroundAccumulation& ground, const ofJson& j) {
+        ofVec3f center = ground.getCenter();
+        float size = ground.getSize(), hills = ground.getHillHeight();
+        uint64_t resolution = uint64_t(ground.getResolution());
+        bool geometry = read(j, "position", center);
+        geometry = read(j, "size", size) || geometry;
+        geometry = read(j, "resolution", resolution) || geometry;
+        geometry = read(j, "hills", hills) || geometry;
+        if (geometry && (center != ground.getCenter() || size != ground.getSize() || int(resolution) != ground.getResolution()
+                         || hills != ground.getHillHeight())) {
+            ground.setup(center, size, int(std::min<uint64_t>(resolution, 1024)), hills);
+        }
+        read(j, "depthPerParticle", ground.depthPerParticle);
+        read(j, "maxDepth", ground.maxDepth);
+        read(j, "color", ground.snowColor);
+    }
+
+    // Wiatr ze sceny (siła dodawana w ofApp::update); bez klucza "wind" - `fallback`
+    inline ofVec3f wind(const ofJson& scene, const ofVec3f& fallback) {
+        ofVec3f w = fallback;
+        read(scene, "wind", w);
+        return w;
+    }
+
+    // Stosuje scenę do systemu - na starcie i przy każdej zmianie pliku (przez FixedStepScheduler::modify).
+    // Żywe cząstki zostają w puli; pula rośnie tylko wtedy, gdy nowe emitery potrzebują więcej miejsca.
+    // reseed = true przy tworzeniu systemu: emitery startują z ziaren z pliku.
+    template<class EmitterType>
+    void apply(ParticleSystem<EmitterType>& system, const ofJson& scene, bool reseed = false) {
+        if (!scene.is_object()) return;
+        float radius;
+        if (read(scene, "particleRadius", radius) && radius > 0) system.particleRadius = radius;
+        std::string layoutName;
+        PoolLayout layout;
+        if (read(scene, "layout", layoutName) && poolLayout(layoutName, layout) && !system.particles.setLayout(layout)) {
+            ofLogWarning("SceneConfig") << "layout " << layoutName << ": wiecej niz 256 rekordow emiterow - uklad bez zmian";
+        }
+
+        auto sphere = scene.find("sphere");
+        if (sphere != scene.end() && sphere->is_object()) {
+            read(*sphere, "position", system.spherePosition);
+            if (read(*sphere, "radius", radius) && radius >= 0) system.sphereRadius = radius;
+        }
+
+        auto interactions = scene.find("interactions");
+        if (interactions != scene.end() && interactions->is_object()) {
+            std::string mode;
+            if (read(*interactions, "mode", mode)) interactionMode(mode, system.interactions.mode);
+            if (read(*interactions, "radius", radius) && radius > 0) system.interactions.radius = radius;
+            read(*interactions, "strength", system.interactions.strength);
+            read(*interactions, "restDensity", system.interactions.restDensity);
+        }
+
+        auto ground = scene.find("ground");
+        if (ground != scene.end() && ground->is_object()) applyGround(system.ground, *ground);
+
+        auto forces = scene.find("forces");
+        if (forces != scene.end() && forces->is_array()) applyForces(system.forces, *forces);
+
+        auto emitters = scene.find("emitters");
+        if (emitters != scene.end() && emitters->is_array()) applyEmitters(system.emitter, *emitters, reseed);
+
+        const size_t needed = ParticleSystem<EmitterType>::estimateCapacity(system.emitter);
+        if (needed > system.particles.capacity()) {
+            system.particles.allocate(needed);
+        }
+    }
+}
+
+// Klasa SceneFile - Plik sceny obserwowany w czasie działania
+// poll() co `checkInterval` sprawdza czas modyfikacji pliku; po zmianie wczytuje go od nowa.
+// Plik z błędem (np. zapisany w połowie przez edytor) nie zmienia sceny - zostaje poprzednia
+// wersja, a błąd jest w error() do czasu kolejnej zmiany pliku.
+class SceneFile {
+public:
+    SceneFile() : checkInterval(std::chrono::milliseconds(250)), version(0) {}
+
+    // Wczytuje plik i zapamiętuje ścieżkę do obserwowania; false, gdy plik nie istnieje albo ma błąd
+    bool open(const std::string& filePath) {
+        path = filePath;
+        scene = ofJson();
+        version = 0;
+        return load();
+    }
+
+    // true, gdy plik zmienił się od ostatniego sprawdzenia i został poprawnie wczytany
+    bool poll() {
+        const Clock::time_point now = Clock::now();
+        if (path.empty() || now < nextCheck) return false;
+        nextCheck = now + checkInterval;
+        std::error_code ec;
+        const std::filesystem::file_time_type time = std::filesystem::last_write_time(path, ec);
+        if (ec || time == stamp) return false;              //Brak pliku (np. w trakcie zapisu) - bez zmian
+        return load();
+    }
+
+    bool loaded() const { return version > 0; }
+    const ofJson& get() const { return scene; }
+    const std::string& error() const { return lastError; }
+    const std::string& filePath() const { return path; }
+    unsigned loadCount() const { return version; }          //Liczba udanych wczytań (1 = tylko start)
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    std::string path;
+    ofJson scene;
+    std::string lastError;
+    std::filesystem::file_time_type stamp;
+    Clock::time_point nextCheck;
+    Clock::duration checkInterval;
+    unsigned version;
+
+    bool load() {
+        std::error_code ec;
+        stamp = std::filesystem::last_write_time(path, ec);     //Także przy błędzie - ten sam plik nie jest czytany co chwilę
+        std::ifstream in(path);
+        if (ec || !in) {
+            lastError = "brak pliku " + path;
+            return false;
+        }
+        ofJson parsed;
+        try {
+            parsed = ofJson::parse(in);
+        } catch (const ofJson::exception& e) {
+            lastError = e.what();
+            ofLogError("SceneFile") << path << ": " << lastError;
+            return false;
+        }
+        if (!parsed.is_object()) {
+            lastError = "scena musi byc obiektem JSON";
+            ofLogError("SceneFile") << path << ": " << lastError;
+            return false;
+        }
+        scene = std::move(parsed);
+        lastError.clear();
+        ++version;
+        return true;
+    }
+};
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ParticleSystem.h"
+#include "Emitter.h"
+#include "EmitterSet.h"
+#include "ChunkedWorld.h"
+
+#include "FixedStepScheduler.h"
+
+// Sceny obu aplikacji - wspólne dla ofApp::setup, resetu klawiszem 'r' i benchmarków bez okna
+namespace Scenes {
+
+    const float stepRate = 120.0f;                      // Kroki symulacji na sekundę (FixedStepScheduler)
+    const int maxStepsPerFrame = 5;                     // Limit nadrabiania po przycięciu klatki
+
+    // myParticleSystem - czerwone cząstki z jednego punktu, odbijające się od kuli
+    inline Emitter sparksEmitter(float rate = 1000) {
+        //              pozycja             predkosc               kolor          czas życia, ilosc na sek, masa, ziarno
+        return Emitter(ofVec3f(-300, -250, 0), ofVec3f(100, 100, 100), ofColor(200, 0, 40), 3.0f, rate, 1.0f, 1);
+    }
+
+    inline void setupSparks(ParticleSystem<Emitter>& system) {
+        system.spherePosition = ofVec3f(0, 0, 0);       // Pozycja i promień kuli do kolizji
+        system.sphereRadius = 100.0f;
+    }
+
+    // Wiatr jest skalowany przez dt - wartości to dawne siły na klatkę razy 60 (ten sam efekt przy 60 fps)
+    inline ofVec3f sparksWind() { return ofVec3f(120, 120, 0); }
+
+    // animacjaSwiateczna - śnieg padający z prostokąta nad sceną
+    inline EmitterSnow snowEmitter(float rate = 400) {
+        return EmitterSnow(ofVec3f(0, 500, 0),          // Pozycja
+                           ofVec3f(1000, 0, 1000),      // Zakres emisji
+                           ofVec3f(1, 1, 1),            // Zakres prędkości
+                           ofColor(255, 255, 255),      // Kolor
+                           5.0f,                        // Czas życia
+                           rate,                        // Szybkość emisji
+                           1.0f,                        // Masa cząstki
+                           2);                          // Ziarno generatora
+    }
+
+    // Opór powietrza ogranicza prędkość płatków, a turbulencja (curl noise) je kołysze
+    inline void addSnowTurbulence(ForceFieldStack& forces) {
+        forces.addDrag(0.5f);
+        forces.addCurlNoise(40.0f, 0.004f, 0.3f);
+    }
+
+    inline void setupSnow(ParticleSystem<EmitterSnow>& system) {
+        system.particleRadius = 1.0f;                   // Płatki śniegu są mniejsze niż domyślne cząstki
+        system.interactions.mode = InteractionMode::None;       // Zlepianie płatków (Clumping) pod klawiszem 'i' - za drogie jako domyślne
+        system.interactions.radius = 6.0f;
+        system.interactions.strength = 20.0f;
+        addSnowTurbulence(system.forces);
+    }
+
+    inline ofVec3f snowWind() { return ofVec3f(60, -120, 0); }
+
+    // Śnieg jednego kawałka ChunkedWorld - pudełko snowEmitter nad środkiem kawałka, strumień losowy kawałka
+    // (kawałek o boku 2000 ma tę samą gęstość płatków co cała scena animacjaSwiateczna)
+    inline EmitterSnow snowChunkEmitter(const ofVec3f& center, float size, uint64_t stream) {
+        EmitterSnow emitter = snowEmitter();
+        emitter.shape = BoxShape(center + emitter.shape.center, ofVec3f(size * 0.5f, 0, size * 0.5f));
+        emitter.random.seed(2, stream);
+        return emitter;
+    }
+
+    // animacjaSwiateczna - śnieg, dym z komina i iskry w jednym systemie (jedna pula, jedno przejście)
+    // Śnieg jest pierwszym emiterem i ma to samo ziarno co snowEmitter - pada tak samo jak sam.
+    inline ofVec3f chimneyTop() { return ofVec3f(-250, -100, 0); }
+
+    // Śnieg żyje 8 s - dłużej niż trwa opadanie, więc płatki kończą na ziemi (setupChristmas), a czas życia
+    // usuwa tylko płatki zwiane poza siatkę ziemi.
+    inline EmitterSet christmasEmitters(float snowRate = 400) {
+        EmitterSet emitters;
+        EmitterSnow snow = snowEmitter(snowRate);
+        snow.lifetime = 8.0f;
+        snow.settles = true;                            //Płatki dokładają śnieg do GroundAccumulation
+        emitters.add(snow);
+        //                      kształt                                       prędkość              zakres prędkości     kolor                   czas życia, ilosc na sek, masa, ziarno
+        emitters.add(ShapeEmitter<DiscShape>(DiscShape(chimneyTop(), ofVec3f(0, 1, 0), 15.0f),
+                                             ofVec3f(0, 60, 0), ofVec3f(8, 10, 8), ofColor(150, 150, 150), 4.0f, 150, 4.0f, 3));   // Dym - ciężki, wiatr słabo go znosi
+        emitters.add(ShapeEmitter<SphereShape>(SphereShape(chimneyTop(), 5.0f, true),
+                                               ofVec3f(0, 80, 0), ofVec3f(30, 30, 30), ofColor(255, 140, 0), 1.5f, 100, 2.0f, 4));  // Iskry z komina
+        return emitters;
+    }
+
+    inline void setupChristmas(ParticleSystem<EmitterSet>& system) {
+        system.particleRadius = 1.0f;                   // Jak w setupSnow
+        system.interactions.mode = InteractionMode::None;
+        system.interactions.radius = 6.0f;
+        system.interactions.strength = 20.0f;
+        addSnowTurbulence(system.forces);
+        //                   środek (y - wysokość ziemi)  bok, węzły, pagórki
+        system.ground.setup(ofVec3f(0, -250, 0), 3200.0f, 96, 40.0f);  // Ziemia pod śniegiem (płatki z wiatrem dryfują w stronę +x)
+    }
+}
@@ -0,0 +1,366 @@
+#include "SimdKernels.h"
+
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define PARTICLES_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// GCC/Clang kompilują funkcje AVX2 bez globalnych flag -mavx2 (reszta programu działa na każdym CPU).
+// MSVC pozwala używać intrinsics bez dodatkowych atrybutów.
+#if defined(__GNUC__) || defined(__clang__)
+#define PARTICLES_TARGET_SSE __attribute__((target("sse2")))
+#define PARTICLES_TARGET_AVX2 __attribute__((target("avx2,f16c")))
+#else
+#define PARTICLES_TARGET_SSE
+#define PARTICLES_TARGET_AVX2
+#endif
+
+namespace {
+
+    //--------------------------------------------------------------
+    // Wersje skalarne - punkt odniesienia i reszta tablicy za ostatnim pełnym wektorem
+
+    void applyForceScalar(float* vx, float* vy, float* vz, const float* invMass, size_t n,
+                          float fx, float fy, float fz) {
+        for (size_t i = 0; i < n; ++i) {
+            vx[i] += fx * invMass[i];
+            vy[i] += fy * invMass[i];
+            vz[i] += fz * invMass[i];
+        }
+    }
+
+    void integrateScalar(float* x, float* y, float* z, const float* vx, const float* vy, const float* vz,
+                         float* age, size_t n, float dt) {
+        for (size_t i = 0; i < n; ++i) {
+            x[i] += vx[i] * dt;
+            y[i] += vy[i] * dt;
+            z[i] += vz[i] * dt;
+            age[i] += dt;
+        }
+    }
+
+    void collideSphereScalar(float* x, float* y, float* z, float* vx, float* vy, float* vz,
+                             size_t n, float cx, float cy, float cz, float r, float dt) {
+        for (size_t i = 0; i < n; ++i) {
+            SimdKernels::sweepSphere(x[i], y[i], z[i], vx[i], vy[i], vz[i], cx, cy, cz, r, dt);
+        }
+    }
+
+    size_t countDeadScalar(const float* age, const float* lifetime, size_t n) {
+        size_t dead = 0;
+        for (size_t i = 0; i < n; ++i) {
+            dead += age[i] > lifetime[i];
+        }
+        return dead;
+    }
+
+    void packHalfScalar(const float* in, uint16_t* out, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = SimdKernels::halfFromFloat(in[i]);
+        }
+    }
+
+    void unpackHalfScalar(const uint16_t* in, float* out, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = SimdKernels::floatFromHalf(in[i]);
+        }
+    }
+
+    int bitCount(int mask) {
+        int count = 0;
+        for (; mask; mask &= mask - 1) ++count;
+        return count;
+    }
+
+#ifdef PARTICLES_X86
+    //--------------------------------------------------------------
+    // SSE - 4 cząstki na instrukcję
+
+    PARTICLES_TARGET_SSE
+    void applyForceSSE(float* vx, float* vy, float* vz, const float* invMass, size_t n,
+                       float fx, float fy, float fz) {
+        const __m128 fxv = _mm_set1_ps(fx), fyv = _mm_set1_ps(fy), fzv = _mm_set1_ps(fz);
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            __m128 im = _mm_loadu_ps(invMass + i);
+            _mm_storeu_ps(vx + i, _mm_add_ps(_mm_loadu_ps(vx + i), _mm_mul_ps(fxv, im)));
+            _mm_storeu_ps(vy + i, _mm_add_ps(_mm_loadu_ps(vy + i), _mm_mul_ps(fyv, im)));
+            _mm_storeu_ps(vz + i, _mm_add_ps(_mm_loadu_ps(vz + i), _mm_mul_ps(fzv, im)));
+        }
+        applyForceScalar(vx + i, vy + i, vz + i, invMass + i, n - i, fx, fy, fz);
+    }
+
+    PARTICLES_TARGET_SSE
+    void integrateSSE(float* x, float* y, float* z, const float* vx, const float* vy, const float* vz,
+                      float* age, size_t n, float dt) {
+        const __m128 dtv = _mm_set1_ps(dt);
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            _mm_storeu_ps(x + i, _mm_add_ps(_mm_loadu_ps(x + i), _mm_mul_ps(_mm_loadu_ps(vx + i), dtv)));
+            _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(_mm_loadu_ps(vy + i), dtv)));
+            _mm_storeu_ps(z + i, _mm_add_ps(_mm_loadu_ps(z + i), _mm_mul_ps(_mm_loadu_ps(vz + i), dtv)));
+            _mm_storeu_ps(age + i, _mm_add_ps(_mm_loadu_ps(age + i), dtv));
+        }
+        integrateScalar(x + i, y + i, z + i, vx + i, vy + i, vz + i, age + i, n - i, dt);
+    }
+
+    // Wektorowo liczony jest tylko test sweepCandidate (te same działania co w wersji skalarnej);
+    // nieliczne trafione cząstki przechodzą przez SimdKernels::sweepSphere - wynik jak w wersji skalarnej.
+    PARTICLES_TARGET_SSE
+    void collideSphereSSE(float* x, float* y, float* z, float* vx, float* vy, float* vz,
+                          size_t n, float cx, float cy, float cz, float r, float dt) {
+        const __m128 cxv = _mm_set1_ps(cx), cyv = _mm_set1_ps(cy), czv = _mm_set1_ps(cz);
+        const __m128 rr = _mm_set1_ps(r * r), dtv = _mm_set1_ps(dt), zero = _mm_setzero_ps(), sign = _mm_set1_ps(-0.0f);
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            __m128 dx = _mm_mul_ps(_mm_loadu_ps(vx + i), dtv);
+            __m128 dy = _mm_mul_ps(_mm_loadu_ps(vy + i), dtv);
+            __m128 dz = _mm_mul_ps(_mm_loadu_ps(vz + i), dtv);
+            __m128 ex = _mm_sub_ps(_mm_loadu_ps(x + i), cxv);
+            __m128 ey = _mm_sub_ps(_mm_loadu_ps(y + i), cyv);
+            __m128 ez = _mm_sub_ps(_mm_loadu_ps(z + i), czv);
+            __m128 mx = _mm_sub_ps(ex, dx), my = _mm_sub_ps(ey, dy), mz = _mm_sub_ps(ez, dz);
+            __m128 a = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+            __m128 b = _mm_add_ps(_mm_add_ps(_mm_mul_ps(mx, dx), _mm_mul_ps(my, dy)), _mm_mul_ps(mz, dz));
+            __m128 c = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(mx, mx), _mm_mul_ps(my, my)), _mm_mul_ps(mz, mz)), rr);
+            __m128 e = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(ex, ex), _mm_mul_ps(ey, ey)), _mm_mul_ps(ez, ez)), rr);
+            __m128 inside = _mm_or_ps(_mm_cmple_ps(c, zero), _mm_cmple_ps(e, zero));
+            __m128 crossing = _mm_and_ps(_mm_and_ps(_mm_cmplt_ps(b, zero), _mm_cmple_ps(_mm_xor_ps(b, sign), a)),
+                                         _mm_cmpge_ps(_mm_sub_ps(_mm_mul_ps(b, b), _mm_mul_ps(a, c)), zero));
+            int mask = _mm_movemask_ps(_mm_or_ps(inside, crossing));
+            if (mask == 0) continue;                            //Najczęstszy przypadek - żadna z 4 cząstek nie zbliża się do kuli
+            for (size_t j = 0; j < 4; ++j) {
+                if (mask & (1 << j)) {
+                    SimdKernels::sweepSphere(x[i + j], y[i + j], z[i + j], vx[i + j], vy[i + j], vz[i + j], cx, cy, cz, r, dt);
+                }
+            }
+        }
+        collideSphereScalar(x + i, y + i, z + i, vx + i, vy + i, vz + i, n - i, cx, cy, cz, r, dt);
+    }
+
+    PARTICLES_TARGET_SSE
+    size_t countDeadSSE(const float* age, const float* lifetime, size_t n) {
+        size_t dead = 0;
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            dead += bitCount(_mm_movemask_ps(_mm_cmpgt_ps(_mm_loadu_ps(age + i), _mm_loadu_ps(lifetime + i))));
+        }
+        return dead + countDeadScalar(age + i, lifetime + i, n - i);
+    }
+
+    // Te same działania na bitach co halfFromFloat / floatFromHalf, po 4 liczby
+    PARTICLES_TARGET_SSE
+    void packHalfSSE(const float* in, uint16_t* out, size_t n) {
+        const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff)), maxHalf = _mm_set1_ps(65504.0f), half = _mm_set1_ps(0.5f);
+        const __m128i bias = _mm_set1_epi32(int(0xfffu - 0x38000000u)), one = _mm_set1_epi32(1), subBias = _mm_set1_epi32(0x3f000000);
+        const __m128i minNormal = _mm_set1_epi32(0x38800000), signBit = _mm_set1_epi32(0x8000);
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            __m128 f = _mm_loadu_ps(in + i);
+            __m128i sign = _mm_and_si128(_mm_srli_epi32(_mm_castps_si128(f), 16), signBit);
+            __m128 a = _mm_min_ps(_mm_and_ps(f, absMask), maxHalf);
+            __m128i u = _mm_castps_si128(a);
+            __m128i normal = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(u, bias), _mm_and_si128(_mm_srli_epi32(u, 13), one)), 13);
+            __m128i sub = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(a, half)), subBias);
+            __m128i isSub = _mm_cmplt_epi32(u, minNormal);
+            __m128i h = _mm_or_si128(sign, _mm_or_si128(_mm_and_si128(isSub, sub), _mm_andnot_si128(isSub, normal)));
+            h = _mm_sub_epi32(h, signBit);                  //packs_epi32 nasyca ze znakiem - przesunięcie do zakresu int16
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out + i), _mm_xor_si128(_mm_packs_epi32(h, h), _mm_set1_epi16(short(0x8000))));
+        }
+        packHalfScalar(in + i, out + i, n - i);
+    }
+
+    PARTICLES_TARGET_SSE
+    void unpackHalfSSE(const uint16_t* in, float* out, size_t n) {
+        const __m128i magnitudeMask = _mm_set1_epi32(0x7fff), bias = _mm_set1_epi32(0x38000000), minNormal = _mm_set1_epi32(0x400);
+        const __m128i signBit = _mm_set1_epi32(0x8000);
+        const __m128 subScale = _mm_set1_ps(1.0f / 16777216.0f);
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            __m128i h = _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(in + i)), _mm_setzero_si128());
+            __m128i magnitude = _mm_and_si128(h, magnitudeMask);
+            __m128 normal = _mm_castsi128_ps(_mm_add_epi32(_mm_slli_epi32(magnitude, 13), bias));
+            __m128 sub = _mm_mul_ps(_mm_cvtepi32_ps(magnitude), subScale);
+            __m128 isSub = _mm_castsi128_ps(_mm_cmplt_epi32(magnitude, minNormal));
+            __m128 f = _mm_or_ps(_mm_and_ps(isSub, sub), _mm_andnot_ps(isSub, normal));
+            _mm_storeu_ps(out + i, _mm_or_ps(f, _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(h, signBit), 16))));
+        }
+        unpackHalfScalar(in + i, out + i, n - i);
+    }
+
+    //--------------------------------------------------------------
+    // AVX2 - 8 cząstek na instrukcję
+
+    PARTICLES_TARGET_AVX2
+    void applyForceAVX2(float* vx, float* vy, float* vz, const float* invMass, size_t n,
+                        float fx, float fy, float fz) {
+        const __m256 fxv = _mm256_set1_ps(fx), fyv = _mm256_set1_ps(fy), fzv = _mm256_set1_ps(fz);
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m256 im = _mm256_loadu_ps(invMass + i);
+            _mm256_storeu_ps(vx + i, _mm256_add_ps(_mm256_loadu_ps(vx + i), _mm256_mul_ps(fxv, im)));
+            _mm256_storeu_ps(vy + i, _mm256_add_ps(_mm256_loadu_ps(vy + i), _mm256_mul_ps(fyv, im)));
+            _mm256_storeu_ps(vz + i, _mm256_add_ps(_mm256_loadu_ps(vz + i), _mm256_mul_ps(fzv, im)));
+        }
+        applyForceScalar(vx + i, vy + i, vz + i, invMass + i, n - i, fx, fy, fz);
+    }
+
+    PARTICLES_TARGET_AVX2
+    void integrateAVX2(float* x, float* y, float* z, const float* vx, const float* vy, const float* vz,
+                       float* age, size_t n, float dt) {
+        const __m256 dtv = _mm256_set1_ps(dt);
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            _mm256_storeu_ps(x + i, _mm256_add_ps(_mm256_loadu_ps(x + i), _mm256_mul_ps(_mm256_loadu_ps(vx + i), dtv)));
+            _mm256_storeu_ps(y + i, _mm256_add_ps(_mm256_loadu_ps(y + i), _mm256_mul_ps(_mm256_loadu_ps(vy + i), dtv)));
+            _mm256_storeu_ps(z + i, _mm256_add_ps(_mm256_loadu_ps(z + i), _mm256_mul_ps(_mm256_loadu_ps(vz + i), dtv)));
+            _mm256_storeu_ps(age + i, _mm256_add_ps(_mm256_loadu_ps(age + i), dtv));
+        }
+        integrateScalar(x + i, y + i, z + i, vx + i, vy + i, vz + i, age + i, n - i, dt);
+    }
+
+    PARTICLES_TARGET_AVX2
+    void collideSphereAVX2(float* x, float* y, float* z, float* vx, float* vy, float* vz,
+                           size_t n, float cx, float cy, float cz, float r, float dt) {
+        const __m256 cxv = _mm256_set1_ps(cx), cyv = _mm256_set1_ps(cy), czv = _mm256_set1_ps(cz);
+        const __m256 rr = _mm256_set1_ps(r * r), dtv = _mm256_set1_ps(dt), zero = _mm256_setzero_ps(), sign = _mm256_set1_ps(-0.0f);
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m256 dx = _mm256_mul_ps(_mm256_loadu_ps(vx + i), dtv);
+            __m256 dy = _mm256_mul_ps(_mm256_loadu_ps(vy + i), dtv);
+            __m256 dz = _mm256_mul_ps(_mm256_loadu_ps(vz + i), dtv);
+            __m256 ex = _mm256_sub_ps(_mm256_loadu_ps(x + i), cxv);
+            __m256 ey = _mm256_sub_ps(_mm256_loadu_ps(y + i), cyv);
+            __m256 ez = _mm256_sub_ps(_mm256_loadu_ps(z + i), czv);
+            __m256 mx = _mm256_sub_ps(ex, dx), my = _mm256_sub_ps(ey, dy), mz = _mm256_sub_ps(ez, dz);
+            __m256 a = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+            __m256 b = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(mx, dx), _mm256_mul_ps(my, dy)), _mm256_mul_ps(mz, dz));
+            __m256 c = _mm256_sub_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(mx, mx), _mm256_mul_ps(my, my)), _mm256_mul_ps(mz, mz)), rr);
+            __m256 e = _mm256_sub_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ex, ex), _mm256_mul_ps(ey, ey)), _mm256_mul_ps(ez, ez)), rr);
+            __m256 inside = _mm256_or_ps(_mm256_cmp_ps(c, zero, _CMP_LE_OQ), _mm256_cmp_ps(e, zero, _CMP_LE_OQ));
+            __m256 crossing = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(b, zero, _CMP_LT_OQ), _mm256_cmp_ps(_mm256_xor_ps(b, sign), a, _CMP_LE_OQ)),
+                                            _mm256_cmp_ps(_mm256_sub_ps(_mm256_mul_ps(b, b), _mm256_mul_ps(a, c)), zero, _CMP_GE_OQ));
+            int mask = _mm256_movemask_ps(_mm256_or_ps(inside, crossing));
+            if (mask == 0) continue;                            //Żadna z 8 cząstek nie zbliża się do kuli
+            for (size_t j = 0; j < 8; ++j) {
+                if (mask & (1 << j)) {
+                    SimdKernels::sweepSphere(x[i + j], y[i + j], z[i + j], vx[i + j], vy[i + j], vz[i + j], cx, cy, cz, r, dt);
+                }
+            }
+        }
+        collideSphereScalar(x + i, y + i, z + i, vx + i, vy + i, vz + i, n - i, cx, cy, cz, r, dt);
+    }
+
+    PARTICLES_TARGET_AVX2
+    size_t countDeadAVX2(const float* age, const float* lifetime, size_t n) {
+        size_t dead = 0;
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            dead += bitCount(_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(age + i), _mm256_loadu_ps(lifetime + i), _CMP_GT_OQ)));
+        }
+        return dead + countDeadScalar(age + i, lifetime + i, n - i);
+    }
+
+    // Konwersja sprzętowa F16C (zaokrąglenie do najbliższej) - po obcięciu do 65504 wynik jak w halfFromFloat
+    PARTICLES_TARGET_AVX2
+    void packHalfAVX2(const float* in, uint16_t* out, size_t n) {
+        const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff)), maxHalf = _mm256_set1_ps(65504.0f);
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m256 f = _mm256_loadu_ps(in + i);
+            __m256 a = _mm256_min_ps(_mm256_and_ps(f, absMask), maxHalf);
+            __m256 clamped = _mm256_or_ps(a, _mm256_andnot_ps(absMask, f));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm256_cvtps_ph(clamped, _MM_FROUND_TO_NEAREST_INT));
+        }
+        packHalfScalar(in + i, out + i, n - i);
+    }
+
+    PARTICLES_TARGET_AVX2
+    void unpackHalfAVX2(const uint16_t* in, float* out, size_t n) {
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            _mm256_storeu_ps(out + i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i))));
+        }
+        unpackHalfScalar(in + i, out + i, n - i);
+    }
+
+    bool cpuHasAVX2() {
+#if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 1);
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        bool avx = (info[2] & (1 << 28)) != 0;
+        bool f16c = (info[2] & (1 << 29)) != 0;            //Konwersje half (packHalf / unpackHalf)
+        if (!osxsave || !avx || !f16c || (_xgetbv(0) & 6) != 6) return false;   //System musi zapisywać rejestry YMM
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        unsigned eax, ebx, ecx, edx;
+        bool f16c = __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_F16C) != 0;
+        return f16c && __builtin_cpu_supports("avx2");
+#endif
+    }
+#endif
+
+    const SimdKernels::Table scalarTable = { applyForceScalar, integrateScalar, collideSphereScalar, countDeadScalar,
+                                             packHalfScalar, unpackHalfScalar };
+#ifdef PARTICLES_X86
+    const SimdKernels::Table sseTable = { applyForceSSE, integrateSSE, collideSphereSSE, countDeadSSE, packHalfSSE, unpackHalfSSE };
+    const SimdKernels::Table avx2Table = { applyForceAVX2, integrateAVX2, collideSphereAVX2, countDeadAVX2, packHalfAVX2, unpackHalfAVX2 };
+#endif
+
+    SimdKernels::Isa& currentIsa() {
+        static SimdKernels::Isa isa = SimdKernels::detectIsa();
+        return isa;
+    }
+}
+
+SimdKernels::Isa SimdKernels::detectIsa() {
+#ifdef PARTICLES_X86
+    return cpuHasAVX2() ? Isa::AVX2 : Isa::SSE;         //SSE2 jest zawsze dostępne na x86-64
+#else
+    return Isa::Scalar;
+#endif
+}
+
+bool SimdKernels::isSupported(Isa isa) {
+    return int(isa) <= int(detectIsa());
+}
+
+const char* SimdKernels::isaName(Isa isa) {
+    switch (isa) {
+        case Isa::Scalar: return "Scalar";
+        case Isa::SSE: return "SSE";
+        case Isa::AVX2: return "AVX2";
+    }
+    return "";
+}
+
+const SimdKernels::Table& SimdKernels::table(Isa isa) {
+#ifdef PARTICLES_X86
+    if (isa == Isa::AVX2) return avx2Table;
+    if (isa == Isa::SSE) return sseTable;
+#endif
+    return scalarTable;
+}
+
+const SimdKernels::Table& SimdKernels::active() {
+    return table(currentIsa());
+}
+
+SimdKernels::Isa SimdKernels::activeIsa() {
+    return currentIsa();
+}
+
+bool SimdKernels::setActiveIsa(Isa isa) {
+    if (!isSupported(isa)) return false;
+    currentIsa() = isa;
+    return true;
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Wektorowe kernele aktualizacji cząstek działające na tablicach ParticlePool (struct-of-arrays)
+// Każdy kernel ma wersję skalarną, SSE (4 cząstki na instrukcję) i AVX2 (8 cząstek).
+// Wersja jest wybierana w czasie działania na podstawie CPU; wszystkie liczą te same
+// działania w tej samej kolejności (bez FMA), więc dają identyczne wyniki.
+namespace SimdKernels {
+
+    enum class Isa {
+        Scalar,
+        SSE,
+        AVX2
+    };
+
+    struct Table {
+        // v += force * invMass
+        void (*applyForce)(float* vx, float* vy, float* vz, const float* invMass, size_t n,
+                           float fx, float fy, float fz);
+        // p += v * dt, age += dt
+        void (*integrate)(float* x, float* y, float* z, const float* vx, const float* vy, const float* vz,
+                          float* age, size_t n, float dt);
+        // Ciągła kolizja z kulą (środek c, promień r) ruchu z ostatniego kroku p - v * dt -> p (sweepSphere)
+        void (*collideSphere)(float* x, float* y, float* z, float* vx, float* vy, float* vz,
+                              size_t n, float cx, float cy, float cz, float r, float dt);
+        // Liczba cząstek z age > lifetime
+        size_t (*countDead)(const float* age, const float* lifetime, size_t n);
+        // float -> half (halfFromFloat) i z powrotem (floatFromHalf) - prędkości w PoolLayout::CompactHalf
+        void (*packHalf)(const float* in, uint16_t* out, size_t n);
+        void (*unpackHalf)(const uint16_t* in, float* out, size_t n);
+    };
+
+    // Konwersja do half (IEEE 754 binary16) z zaokrągleniem do najbliższej (remis do parzystej), jak F16C.
+    // Wartości powyżej 65504 (i NaN) dają największą skończoną wartość half - bez nieskończonej prędkości.
+    // Bez rozgałęzień po zakresie: ta sama formuła jest liczona w kernelach SSE na 4 liczbach naraz.
+    inline uint16_t halfFromFloat(float f) {
+        uint32_t u;
+        std::memcpy(&u, &f, sizeof(u));
+        const uint32_t sign = (u >> 16) & 0x8000u;
+        float a = std::fabs(f);
+        a = a < 65504.0f ? a : 65504.0f;                            //NaN też daje 65504
+        std::memcpy(&u, &a, sizeof(u));
+        const uint32_t normal = (u - 0x38000000u + 0xfffu + ((u >> 13) & 1u)) >> 13;  //Wykładnik 127 -> 15, zaokrąglenie 13 bitów
+        float s = a + 0.5f;                                         //Podnormalne half: ulp liczby 0.5 to 2^-24 - zaokrągla FPU
+        uint32_t sub;
+        std::memcpy(&sub, &s, sizeof(sub));
+        sub -= 0x3f000000u;
+        return uint16_t(sign | (u < 0x38800000u ? sub : normal));
+    }
+
+    inline float floatFromHalf(uint16_t h) {
+        const uint32_t magnitude = h & 0x7fffu;
+        const uint32_t normal = (magnitude << 13) + 0x38000000u;   //Wykładnik 15 -> 127 (halfFromFloat nie daje inf/NaN)
+        float f;
+        std::memcpy(&f, &normal, sizeof(f));
+        if (magnitude < 0x400u) f = float(magnitude) * (1.0f / 16777216.0f);  //Podnormalne i zero - dokładnie
+        return (h & 0x8000u) ? -f : f;
+    }
+
+    // Czy odcinek ruchu może zahaczyć o kulę - te same działania w kernelach wektorowych (bez pierwiastka):
+    // a = |d|^2, b = m . d, c = |m|^2 - r^2, e = |p - c|^2 - r^2; m - początek odcinka, d - przesunięcie
+    inline bool sweepCandidate(float a, float b, float c, float e) {
+        return c <= 0 || e <= 0 || (b < 0 && -b <= a && b * b - a * c >= 0);
+    }
+
+    // Zderzenie odcinka ruchu z kulą (ciągła detekcja kolizji) dla jednej cząstki po kroku całkowania
+    // Początek kroku to p - v * dt. Gdy odcinek wchodzi w kulę, cząstka wraca do punktu zderzenia (czas t),
+    // prędkość odbija się od normalnej w tym punkcie (v -= 2 (v . n) n), a reszta kroku (1 - t) * dt
+    // jest liczona z nową prędkością - szybka cząstka nie przelatuje przez kulę przy dużym dt.
+    // Cząstka, która była w kuli już na początku kroku i w niej została, jest wypychana na powierzchnię.
+    // Zwraca true, gdy cząstka została zmieniona.
+    inline bool sweepSphere(float& x, float& y, float& z, float& vx, float& vy, float& vz,
+                            float cx, float cy, float cz, float r, float dt) {
+        const float rr = r * r;
+        const float dx = vx * dt, dy = vy * dt, dz = vz * dt;      //Przesunięcie w kroku
+        const float ex = x - cx, ey = y - cy, ez = z - cz;          //Koniec odcinka względem środka kuli
+        const float mx = ex - dx, my = ey - dy, mz = ez - dz;       //Początek odcinka względem środka kuli
+        const float a = dx * dx + dy * dy + dz * dz;
+        const float b = mx * dx + my * dy + mz * dz;
+        const float c = mx * mx + my * my + mz * mz - rr;
+        const float e = ex * ex + ey * ey + ez * ez - rr;
+        if (!sweepCandidate(a, b, c, e)) return false;
+
+        float rest = 0;                                             //Reszta kroku po odbiciu (0 przy wypchnięciu)
+        float qx = ex, qy = ey, qz = ez;                            //Punkt zderzenia względem środka
+        if (c > 0) {                                                //Wejście w kulę w trakcie kroku
+            float t = (-b - std::sqrt(std::max(b * b - a * c, 0.0f))) / a;     //Czas zderzenia jako ułamek kroku
+            t = std::min(std::max(t, 0.0f), 1.0f);
+            rest = (1 - t) * dt;
+            qx = mx + dx * t;
+            qy = my + dy * t;
+            qz = mz + dz * t;
+        } else if (e > 0) {
+            return false;                                           //Była w kuli i właśnie z niej wychodzi
+        }
+        const float len = std::sqrt(qx * qx + qy * qy + qz * qz);
+        if (len == 0) return false;                                 //Środek kuli - brak kierunku normalnej
+        const float nx = qx / len, ny = qy / len, nz = qz / len;
+        const float vn = vx * nx + vy * ny + vz * nz;
+        if (vn < 0) {                                               //Odbicie tylko przy ruchu w głąb kuli
+            vx -= 2 * vn * nx;
+            vy -= 2 * vn * ny;
+            vz -= 2 * vn * nz;
+        }
+        x = cx + nx * r + vx * rest;
+        y = cy + ny * r + vy * rest;
+        z = cz + nz * r + vz * rest;
+        return true;
+    }
+
+    Isa detectIsa();                        //Najlepszy zestaw instrukcji obsługiwany przez CPU
+    bool isSupported(Isa isa);
+    const char* isaName(Isa isa);
+    const Table& table(Isa isa);            //Kernele dla danego zestawu (musi być obsługiwany)
+
+    const Table& active();                  //Kernele używane przez ParticleSystem
+    Isa activeIsa();
+    bool setActiveIsa(Isa isa);             //Wymusza zestaw instrukcji (np. w benchmarku); false jeśli nieobsługiwany
+}
@@ -0,0 +1,311 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ParticlePool.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Format nagrania symulacji (.prec) - stan cząstek klatka po klatce, do odtwarzania bez symulacji
+//   nagłówek pliku:  "PREC", wersja, rozdzielczość (kroków kwantyzacji na jednostkę), odstęp klatek kluczowych
+//   klatka:          liczba cząstek, rozmiar danych, czas [s], dane
+//   dane klatki:     delty x wszystkich cząstek, potem y, z i kolory
+// Pozycja jest zaokrąglana do 1 / resolution i zapisana jako int32. Delta to różnica względem cząstki
+// o tym samym indeksie w poprzedniej klatce (w klatce kluczowej - względem zera), zapisana jako
+// zigzag + varint: cząstka przesuwająca się o kilka jednostek na klatkę zajmuje 2 bajty na oś.
+// Kolor to XOR z poprzednim (niezmieniony kolor = 1 bajt). Usuwanie martwych cząstek zmienia indeksy
+// tylko kilku cząstek - dla nich delta jest po prostu większa. Liczby zapisywane jako little-endian.
+namespace SimulationRecording {
+
+    struct FileHeader {
+        char magic[4];
+        uint32_t version;
+        float resolution;                   //Kroki kwantyzacji pozycji na jednostkę
+        uint32_t keyframeInterval;          //Co ile klatek klatka kluczowa (punkt startu przy przewijaniu)
+    };
+
+    struct FrameHeader {
+        uint32_t count;                     //Liczba cząstek
+        uint32_t payloadBytes;              //Rozmiar danych za nagłówkiem
+        double time;                        //Czas symulacji klatki w sekundach
+    };
+
+    static_assert(sizeof(FileHeader) == 16 && sizeof(FrameHeader) == 16, "Układ nagłówków .prec");
+
+    const uint32_t version = 1;
+    const size_t rawBytesPerParticle = 3 * sizeof(float) + sizeof(ofColor);   //Stan bez kompresji (do porównań)
+
+    inline uint32_t zigzag(int32_t v) { return (uint32_t(v) << 1) ^ uint32_t(v >> 31); }
+    inline int32_t unzigzag(uint32_t v) { return int32_t(v >> 1) ^ -int32_t(v & 1); }
+
+    const size_t maxVarintBytes = 5;
+
+    inline void putVarint(uint8_t*& p, uint32_t v) {
+        while (v >= 0x80) {
+            *p++ = uint8_t(v | 0x80);
+            v >>= 7;
+        }
+        *p++ = uint8_t(v);
+    }
+
+    // false przy końcu danych albo zbyt długiej liczbie (uszkodzony plik)
+    inline bool getVarint(const uint8_t*& p, const uint8_t* end, uint32_t& v) {
+        v = 0;
+        for (int shift = 0; shift < 35; shift += 7) {
+            if (p == end) return false;
+            uint8_t b = *p++;
+            v |= uint32_t(b & 0x7f) << shift;
+            if (!(b & 0x80)) return true;
+        }
+        return false;
+    }
+
+    inline uint32_t packColor(const ofColor& c) {
+        return uint32_t(c.r) | (uint32_t(c.g) << 8) | (uint32_t(c.b) << 16) | (uint32_t(c.a) << 24);
+    }
+
+    inline ofColor unpackColor(uint32_t v) {
+        return ofColor(v & 0xff, (v >> 8) & 0xff, (v >> 16) & 0xff, v >> 24);
+    }
+
+    inline int32_t quantize(float v, float resolution) {
+        float q = std::min(std::max(v * resolution, -1073741824.0f), 1073741824.0f);   //+-2^30 - delta mieści się w int32
+        return int32_t(q + (q < 0 ? -0.5f : 0.5f));     //Zaokrąglenie jak std::round, bez wywołania funkcji
+    }
+
+    // Stan poprzedniej klatki przed kodowaniem/dekodowaniem klatki o `count` cząstkach:
+    // w klatce kluczowej same zera, w pozostałych nowe indeksy (ponad poprzednią liczbę) też od zera
+    inline void prepareBase(std::vector<int32_t>& v, size_t count, bool keyframe) {
+        if (keyframe) {
+            v.assign(count, 0);
+        } else {
+            v.resize(count, 0);
+        }
+    }
+}
+
+// Klasa SimulationRecorder - Zapisuje stan puli klatka po klatce do pliku .prec
+// Dane klatki są kodowane do bufora wielokrotnego użytku (o rozmiarze najgorszego przypadku,
+// bez sprawdzania końca przy każdym bajcie) i zapisywane jednym wywołaniem write.
+class SimulationRecorder {
+public:
+    SimulationRecorder() : resolution(64.0f), keyframeInterval(120), frames(0), bytes(0), particles(0) {}
+    ~SimulationRecorder() { close(); }
+
+    // resolution - kroki na jednostkę (64: błąd pozycji <= 1/128), keyframeInterval - odstęp klatek kluczowych
+    bool open(const std::string& path, float quantizationResolution = 64.0f, uint32_t keyframes = 120) {
+        close();
+        out.open(path, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+        resolution = quantizationResolution;
+        keyframeInterval = std::max(keyframes, 1u);
+        frames = 0;
+        particles = 0;
+        SimulationRecording::FileHeader header = { { 'P', 'R', 'E', 'C' }, SimulationRecording::version, resolution, keyframeInterval };
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        bytes = sizeof(header);
+        return bool(out);
+    }
+
+    bool isOpen() const { return out.is_open(); }
+
+    // Dopisuje klatkę: pozycje i kolory cząstek z puli w chwili `time`
+    void addFrame(const ParticlePool& pool, double time) {
+        if (!out.is_open()) return;
+        using namespace SimulationRecording;
+        const size_t n = pool.size();
+        const bool keyframe = frames % keyframeInterval == 0;
+
+        if (payload.size() < 4 * maxVarintBytes * n) payload.resize(4 * maxVarintBytes * n);
+        uint8_t* p = payload.data();
+        encodeAxis(pool.x.data(), n, prevX, keyframe, p);
+        encodeAxis(pool.y.data(), n, prevY, keyframe, p);
+        encodeAxis(pool.z.data(), n, prevZ, keyframe, p);
+        if (keyframe) {
+            prevColor.assign(n, 0);
+        } else {
+            prevColor.resize(n, 0);
+        }
+        for (size_t i = 0; i < n; ++i) {
+            uint32_t c = packColor(pool.colorAt(i));
+            putVarint(p, c ^ prevColor[i]);
+            prevColor[i] = c;
+        }
+        const size_t payloadBytes = p - payload.data();
+
+        FrameHeader frame = { uint32_t(n), uint32_t(payloadBytes), time };
+        out.write(reinterpret_cast<const char*>(&frame), sizeof(frame));
+        out.write(reinterpret_cast<const char*>(payload.data()), std::streamsize(payloadBytes));
+        ++frames;
+        bytes += sizeof(frame) + payloadBytes;
+        particles += n;
+    }
+
+    void close() {
+        if (out.is_open()) out.close();
+    }
+
+    size_t frameCount() const { return frames; }
+    uint64_t bytesWritten() const { return bytes; }
+    uint64_t particlesWritten() const { return particles; }    //Suma liczby cząstek po klatkach
+
+private:
+    std::ofstream out;
+    float resolution;
+    uint32_t keyframeInterval;
+    size_t frames;
+    uint64_t bytes;
+    uint64_t particles;
+
+    std::vector<int32_t> prevX, prevY, prevZ;       //Skwantowany stan poprzedniej klatki
+    std::vector<uint32_t> prevColor;
+    std::vector<uint8_t> payload;          //Bufor klatki - rośnie tylko razem z liczbą cząstek
+
+    void encodeAxis(const float* v, size_t n, std::vector<int32_t>& prev, bool keyframe, uint8_t*& p) {
+        using namespace SimulationRecording;
+        prepareBase(prev, n, keyframe);
+        for (size_t i = 0; i < n; ++i) {
+            int32_t q = quantize(v[i], resolution);
+            putVarint(p, zigzag(q - prev[i]));
+            prev[i] = q;
+        }
+    }
+};
+
+// Klasa SimulationReplay - Odtwarza nagranie .prec z pliku zmapowanego w pamięci
+// Przy otwarciu przechodzi tylko po nagłówkach klatek (przesunięcia i czasy); dane klatki są
+// dekodowane na żądanie prosto z mapowania. Kolejne klatki dekodują jedną deltę, skok wstecz
+// albo o wiele klatek zaczyna od najbliższej klatki kluczowej.
+// Odczytana pula ma zerowe prędkości, więc rysowanie z rewind = 0 pokazuje dokładnie nagrany stan.
+class SimulationReplay {
+public:
+    SimulationReplay() : resolution(64.0f), keyframeInterval(1), decodedFrame(npos) {}
+
+    bool open(const std::string& path) {
+        using namespace SimulationRecording;
+        close();
+        if (!file.open(path) || file.size() < sizeof(FileHeader)) {
+            file.close();
+            return false;
+        }
+        FileHeader header;
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (std::memcmp(header.magic, "PREC", 4) != 0 || header.version != version || header.keyframeInterval == 0) {
+            file.close();
+            return false;
+        }
+        resolution = header.resolution;
+        keyframeInterval = header.keyframeInterval;
+
+        size_t offset = sizeof(FileHeader);
+        while (offset + sizeof(FrameHeader) <= file.size()) {     //Ucięta ostatnia klatka (przerwane nagranie) jest pomijana
+            FrameHeader frame;
+            std::memcpy(&frame, file.data() + offset, sizeof(frame));
+            if (offset + sizeof(frame) + frame.payloadBytes > file.size()) break;
+            offsets.push_back(offset);
+            times.push_back(frame.time);
+            offset += sizeof(frame) + frame.payloadBytes;
+        }
+        return true;
+    }
+
+    void close() {
+        file.close();
+        offsets.clear();
+        times.clear();
+        decodedFrame = npos;
+    }
+
+    bool isOpen() const { return file.isOpen(); }
+    size_t frameCount() const { return offsets.size(); }
+    double frameTime(size_t i) const { return times[i]; }
+    double duration() const { return times.empty() ? 0.0 : times.back() - times.front(); }
+    float getResolution() const { return resolution; }
+
+    // Ostatnia klatka nagrana nie później niż `time` (pierwsza, gdy time jest przed początkiem)
+    size_t frameAt(double time) const {
+        size_t i = std::upper_bound(times.begin(), times.end(), time) - times.begin();
+        return i == 0 ? 0 : i - 1;
+    }
+
+    // Zapisuje klatkę `i` do puli (pozycje i kolory; prędkości 0, cząstki żywe). false przy uszkodzonym pliku
+    // albo gdy klatka ma więcej cząstek, niż mieści pula o stałej pojemności.
+    bool readFrame(size_t i, ParticlePool& pool) {
+        if (i >= frameCount()) return false;
+        const size_t key = i - i % keyframeInterval;
+        size_t f = (decodedFrame != npos && decodedFrame >= key && decodedFrame <= i) ? decodedFrame + 1 : key;
+        for (; f <= i; ++f) {
+            if (!decode(f)) {
+                decodedFrame = npos;
+                return false;
+            }
+            decodedFrame = f;
+        }
+
+        const size_t n = qx.size();
+        if (pool.capacity() > 0 && n > pool.capacity()) return false;
+        const float step = 1.0f / resolution;
+        pool.setLayout(PoolLayout::Full);                           //Kolor osobno dla każdej cząstki, jak w nagraniu
+        pool.resize(n);
+        for (size_t k = 0; k < n; ++k) {
+            pool.x[k] = float(qx[k]) * step;
+            pool.y[k] = float(qy[k]) * step;
+            pool.z[k] = float(qz[k]) * step;
+            pool.color[k] = SimulationRecording::unpackColor(uint32_t(colors[k]));
+        }
+        std::fill_n(pool.vx.data(), n, 0.0f);
+        std::fill_n(pool.vy.data(), n, 0.0f);
+        std::fill_n(pool.vz.data(), n, 0.0f);
+        std::fill_n(pool.age.data(), n, 0.0f);
+        std::fill_n(pool.lifetime.data(), n, 1.0f);
+        std::fill_n(pool.invMass.data(), n, 1.0f);
+        std::fill_n(pool.flags.data(), n, uint8_t(0));
+        return true;
+    }
+
+private:
+    static const size_t npos = size_t(-1);
+
+    MappedFile file;
+    float resolution;
+    uint32_t keyframeInterval;
+    std::vector<size_t> offsets;            //Początek nagłówka każdej klatki w pliku
+    std::vector<double> times;
+
+    size_t decodedFrame;                    //Klatka, której stan jest w qx..colors
+    std::vector<int32_t> qx, qy, qz, colors;
+
+    bool decode(size_t f) {
+        using namespace SimulationRecording;
+        FrameHeader frame;
+        std::memcpy(&frame, file.data() + offsets[f], sizeof(frame));
+        const uint8_t* p = file.data() + offsets[f] + sizeof(frame);
+        const uint8_t* end = p + frame.payloadBytes;
+        const bool keyframe = f % keyframeInterval == 0;
+        const size_t n = frame.count;
+        if (f != 0 && !keyframe && decodedFrame != f - 1) return false;
+        if (uint64_t(n) * 4 > frame.payloadBytes) return false;     //Cząstka to co najmniej 4 bajty (varint na oś i kolor) - przed alokacją
+
+        for (std::vector<int32_t>* axis : { &qx, &qy, &qz }) {
+            prepareBase(*axis, n, keyframe);
+            int32_t* q = axis->data();
+            for (size_t i = 0; i < n; ++i) {
+                uint32_t v;
+                if (!getVarint(p, end, v)) return false;
+                q[i] += unzigzag(v);
+            }
+        }
+        prepareBase(colors, n, keyframe);
+        for (size_t i = 0; i < n; ++i) {
+            uint32_t v;
+            if (!getVarint(p, end, v)) return false;
+            colors[i] = int32_t(uint32_t(colors[i]) ^ v);
+        }
+        return p == end;
+    }
+};
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Klasa SpatialHash - Haszowana siatka do szukania sąsiadów cząstek
+// Przestrzeń jest podzielona na komórki o boku cellSize; komórka (ix, iy, iz) ma klucz (po 21 bitów
+// na współrzędną) i trafia do kubełka hash(klucz) w tablicy o rozmiarze potęgi dwójki >= 2n.
+// Budowa to sortowanie przez zliczanie: 1) liczba cząstek w kubełkach, 2) sumy prefiksowe,
+// 3) indeksy cząstek pogrupowane kubełkami, a w kubełku - komórkami. Każda niepusta komórka to ciągły
+// zakres posortowanych cząstek, a kubełek wskazuje swoje komórki - kolizje haszy rozstrzyga klucz,
+// więc sąsiednie komórki to zawsze rozłączne zakresy bez cząstek z obcych komórek.
+// Zapytania idą komórka po komórce: 27 sąsiednich zakresów jest wyszukiwanych raz dla całej komórki,
+// a pozycje (skopiowane w kolejności komórek) są czytane po kolei, a nie losowo z puli.
+// Tablice są używane ponownie przy każdej budowie - w stanie ustalonym bez alokacji.
+class SpatialHash {
+public:
+    static const int maxRanges = 27;
+
+    SpatialHash() : cellSize(1.0f), invCellSize(1.0f), mask(0) {}
+
+    void build(const float* x, const float* y, const float* z, size_t n, float cell) {
+        cellSize = cell;
+        invCellSize = 1.0f / cell;
+
+        size_t tableSize = 1;
+        while (tableSize < 2 * n) tableSize <<= 1;
+        mask = uint32_t(tableSize - 1);
+
+        bucketStart.assign(tableSize + 1, 0);
+        particleKey.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t key = pack(coord(x[i]), coord(y[i]), coord(z[i]));
+            particleKey[i] = key;
+            ++bucketStart[bucketOf(key) + 1];
+        }
+        for (size_t b = 0; b < tableSize; ++b) {
+            bucketStart[b + 1] += bucketStart[b];
+        }
+        sorted.resize(n);
+        sortedKey.resize(n);
+        bucketFill.assign(bucketStart.begin(), bucketStart.end() - 1);
+        for (size_t i = 0; i < n; ++i) {
+            uint32_t k = bucketFill[bucketOf(particleKey[i])]++;
+            sorted[k] = uint32_t(i);
+            sortedKey[k] = particleKey[i];
+        }
+
+        // Komórki w kubełku: stabilne sortowanie przez wstawianie po kluczu (kubełek to zwykle jedna komórka -
+        // jedno przejście bez przestawień), potem granice komórek i komórki każdego kubełka
+        cellKey.clear();
+        cellStart.clear();
+        bucketCells.assign(tableSize + 1, 0);
+        for (size_t b = 0; b < tableSize; ++b) {
+            const uint32_t begin = bucketStart[b], end = bucketStart[b + 1];
+            for (uint32_t k = begin + 1; k < end; ++k) {
+                const uint64_t key = sortedKey[k];
+                if (key >= sortedKey[k - 1]) continue;
+                const uint32_t index = sorted[k];
+                uint32_t m = k;
+                for (; m > begin && sortedKey[m - 1] > key; --m) {
+                    sortedKey[m] = sortedKey[m - 1];
+                    sorted[m] = sorted[m - 1];
+                }
+                sortedKey[m] = key;
+                sorted[m] = index;
+            }
+            for (uint32_t k = begin; k < end; ++k) {
+                if (k == begin || sortedKey[k] != sortedKey[k - 1]) {
+                    cellKey.push_back(sortedKey[k]);
+                    cellStart.push_back(k);
+                }
+            }
+            bucketCells[b + 1] = uint32_t(cellKey.size());
+        }
+        cellStart.push_back(uint32_t(n));
+
+        sortedX.resize(n);
+        sortedY.resize(n);
+        sortedZ.resize(n);
+        for (size_t k = 0; k < n; ++k) {
+            const uint32_t i = sorted[k];
+            sortedX[k] = x[i];
+            sortedY[k] = y[i];
+            sortedZ[k] = z[i];
+        }
+    }
+
+    // Niepuste komórki w kolejności posortowanych cząstek; cząstki komórki c to [cellBegin(c), cellEnd(c))
+    size_t cellCount() const { return cellKey.size(); }
+    uint32_t cellBegin(size_t c) const { return cellStart[c]; }
+    uint32_t cellEnd(size_t c) const { return cellStart[c + 1]; }
+
+    // Zakresy posortowanych cząstek z 27 komórek wokół komórki c (łącznie z nią) - zwraca liczbę niepustych zakresów.
+    // Zakresy są rozłączne; odległość i tak sprawdza wywołujący (komórka ma bok promienia, nie kulę).
+    int neighbourRanges(size_t c, uint32_t* begin, uint32_t* end) const {
+        const uint64_t key = cellKey[c];
+        return rangesAround(uint32_t(key) & coordMask, uint32_t(key >> coordBits) & coordMask,
+                            uint32_t(key >> (2 * coordBits)), begin, end);
+    }
+
+    // Wywołuje f(j, xj, yj, zj) dla każdej cząstki j z 27 komórek wokół punktu (px, py, pz).
+    // Wygodne dla pojedynczych zapytań; przejście po wszystkich cząstkach powinno iść po komórkach (neighbourRanges).
+    template<class F>
+    void forEachCandidate(float px, float py, float pz, F f) const {
+        if (sorted.empty()) return;
+        uint32_t begin[maxRanges], end[maxRanges];
+        const int ranges = rangesAround(coord(px), coord(py), coord(pz), begin, end);
+        for (int r = 0; r < ranges; ++r) {
+            for (uint32_t k = begin[r]; k < end[r]; ++k) {
+                f(sorted[k], sortedX[k], sortedY[k], sortedZ[k]);
+            }
+        }
+    }
+
+    float getCellSize() const { return cellSize; }
+    const std::vector<uint32_t>& order() const { return sorted; }  //Indeks w puli dla każdej posortowanej cząstki
+    const float* positionsX() const { return sortedX.data(); }      //Pozycje w kolejności `order`
+    const float* positionsY() const { return sortedY.data(); }
+    const float* positionsZ() const { return sortedZ.data(); }
+
+private:
+    static const int coordBits = 21;                //Współrzędne komórek modulo 2^21 - komórki tak odległe
+    static const uint32_t coordMask = (1u << coordBits) - 1;       //dzielą klucz, co tylko dodaje kandydatów
+
+    float cellSize, invCellSize;
+    uint32_t mask;
+    std::vector<uint32_t> bucketStart;      //Początek kubełka b w `sorted` (tableSize + 1 elementów)
+    std::vector<uint32_t> bucketCells;      //Komórki kubełka b: [bucketCells[b], bucketCells[b + 1]) w cellKey
+    std::vector<uint64_t> cellKey;          //Klucz każdej niepustej komórki
+    std::vector<uint32_t> cellStart;        //Początek komórki w `sorted` (liczba komórek + 1 elementów)
+    std::vector<uint32_t> sorted;           //Indeksy cząstek pogrupowane kubełkami i komórkami
+    std::vector<float> sortedX, sortedY, sortedZ;   //Pozycje w tej samej kolejności co `sorted`
+    std::vector<uint64_t> particleKey;      //Klucz komórki każdej cząstki (pomocnicze przy budowie)
+    std::vector<uint64_t> sortedKey;
+    std::vector<uint32_t> bucketFill;
+
+    uint32_t coord(float v) const {
+        float c = std::floor(v * invCellSize);
+        return uint32_t(int(std::min(std::max(c, -1e9f), 1e9f))) & coordMask;     //Bez przepełnienia int dla odległych cząstek
+    }
+
+    static uint64_t pack(uint32_t cx, uint32_t cy, uint32_t cz) {
+        return uint64_t(cx & coordMask) | uint64_t(cy & coordMask) << coordBits | uint64_t(cz & coordMask) << (2 * coordBits);
+    }
+
+    uint32_t bucketOf(uint64_t key) const {
+        const uint32_t cx = uint32_t(key) & coordMask, cy = uint32_t(key >> coordBits) & coordMask;
+        const uint32_t cz = uint32_t(key >> (2 * coordBits));
+        uint32_t h = cx * 73856093u ^ cy * 19349663u ^ cz * 83492791u;
+        return h & mask;
+    }
+
+    int rangesAround(uint32_t cx, uint32_t cy, uint32_t cz, uint32_t* begin, uint32_t* end) const {
+        int count = 0;
+        for (uint32_t dz = 0; dz < 3; ++dz) {
+            for (uint32_t dy = 0; dy < 3; ++dy) {
+                for (uint32_t dx = 0; dx < 3; ++dx) {
+                    const uint64_t key = pack(cx + dx - 1, cy + dy - 1, cz + dz - 1);
+                    const uint32_t b = bucketOf(key);
+                    for (uint32_t c = bucketCells[b]; c < bucketCells[b + 1]; ++c) {
+                        if (cellKey[c] != key) continue;
+                        begin[count] = cellStart[c];
+                        end[count] = cellStart[c + 1];
+                        ++count;
+                        break;
+                    }
+                }
+            }
+        }
+        return count;
+    }
+};
@@ -0,0 +1,198 @@
+#pragma once
+
+#include "ofMain.h"
+#include "SimdKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Kula do kolizji
+struct SphereCollider {
+    ofVec3f center;
+    float radius;
+};
+
+// Klasa SphereColliderSet - Dowolna liczba kul do kolizji z jednorodną siatką (broad phase)
+// Każda kula jest wpisana do komórek siatki, na które nachodzi jej prostopadłościan otaczający.
+// Cząstka sprawdza tylko kule z własnej komórki - koszt nie rośnie z liczbą wszystkich kul.
+// Siatka jest trzymana w układzie CSR (cellStart + cellSpheres) i budowana sortowaniem
+// przez zliczanie; przy ponownej budowie tablice są używane ponownie (bez alokacji, jeśli nie rosną).
+// Odpowiedź na kolizję jest ta sama co dla pojedynczej kuli: ciągła detekcja SimdKernels::sweepSphere.
+// Cząstka sprawdza kule ze wszystkich komórek prostopadłościanu wokół odcinka ruchu z ostatniego kroku
+// (powiększonego o długość kroku - po odbiciu cząstka zostaje w tym zasięgu), w kolejności indeksów.
+class SphereColliderSet {
+public:
+    SphereColliderSet() : dirty(false), cellSize(1.0f), invCellSize(1.0f), gridMin(0, 0, 0) {
+        dims[0] = dims[1] = dims[2] = 0;
+    }
+
+    size_t size() const { return spheres.size(); }
+    bool empty() const { return spheres.empty(); }
+    const SphereCollider& operator[](size_t i) const { return spheres[i]; }
+
+    void add(const ofVec3f& center, float radius) {
+        spheres.push_back(SphereCollider{ center, radius });
+        dirty = true;
+    }
+
+    void clear() {
+        spheres.clear();
+        dirty = true;
+    }
+
+    void setCenter(size_t i, const ofVec3f& center) {   //Ruchoma kula - siatka zostanie przebudowana przed kolejną kolizją
+        spheres[i].center = center;
+        dirty = true;
+    }
+
+    void setRadius(size_t i, float radius) {
+        spheres[i].radius = radius;
+        dirty = true;
+    }
+
+    bool needsRebuild() const { return dirty; }
+
+    // Buduje siatkę od nowa; wywoływane z ParticleSystem::update przed równoległym przejściem
+    void rebuild() {
+        dirty = false;
+        const size_t count = spheres.size();
+        if (count <= bruteForceLimit) {
+            dims[0] = dims[1] = dims[2] = 0;
+            return;
+        }
+
+        ofVec3f lo = spheres[0].center, hi = spheres[0].center;
+        float radiusSum = 0;
+        for (const auto& s : spheres) {
+            lo.x = std::min(lo.x, s.center.x - s.radius); hi.x = std::max(hi.x, s.center.x + s.radius);
+            lo.y = std::min(lo.y, s.center.y - s.radius); hi.y = std::max(hi.y, s.center.y + s.radius);
+            lo.z = std::min(lo.z, s.center.z - s.radius); hi.z = std::max(hi.z, s.center.z + s.radius);
+            radiusSum += s.radius;
+        }
+        ofVec3f extent = hi - lo;
+
+        // Komórka mniej więcej na jedną kulę, ale nie mniejsza niż średnica średniej kuli
+        // (mniejsze komórki tylko powielają kule w wielu komórkach)
+        float volume = std::max(extent.x, 1.0f) * std::max(extent.y, 1.0f) * std::max(extent.z, 1.0f);
+        cellSize = std::max(std::cbrt(volume / float(count)), 2.0f * radiusSum / float(count));
+        for (int pass = 0; pass < 32; ++pass) {            //Ograniczenie liczby komórek
+            for (int a = 0; a < 3; ++a) {
+                float e = a == 0 ? extent.x : (a == 1 ? extent.y : extent.z);
+                dims[a] = int(std::floor(e / cellSize)) + 1;  //+1: punkt na górnej granicy też ma komórkę
+            }
+            if (size_t(dims[0]) * dims[1] * dims[2] <= maxCells) break;
+            cellSize *= 1.5f;
+        }
+        invCellSize = 1.0f / cellSize;
+        gridMin = lo;
+
+        const size_t cells = size_t(dims[0]) * dims[1] * dims[2];
+        cellStart.assign(cells + 1, 0);
+
+        // Sortowanie przez zliczanie: 1) liczba kul w każdej komórce, 2) sumy prefiksowe, 3) wpisanie indeksów
+        for (size_t s = 0; s < count; ++s) {
+            int lo3[3], hi3[3];
+            cellRange(spheres[s], lo3, hi3);
+            for (int z = lo3[2]; z <= hi3[2]; ++z)
+                for (int y = lo3[1]; y <= hi3[1]; ++y)
+                    for (int x = lo3[0]; x <= hi3[0]; ++x)
+                        ++cellStart[cellIndex(x, y, z) + 1];
+        }
+        for (size_t c = 0; c < cells; ++c) {
+            cellStart[c + 1] += cellStart[c];
+        }
+        cellSpheres.resize(cellStart[cells]);
+        cellFill.assign(cellStart.begin(), cellStart.end() - 1);
+        for (size_t s = 0; s < count; ++s) {               //Kolejność rosnąca - cząstka odbija się od kul w kolejności indeksów
+            int lo3[3], hi3[3];
+            cellRange(spheres[s], lo3, hi3);
+            for (int z = lo3[2]; z <= hi3[2]; ++z)
+                for (int y = lo3[1]; y <= hi3[1]; ++y)
+                    for (int x = lo3[0]; x <= hi3[0]; ++x)
+                        cellSpheres[cellFill[cellIndex(x, y, z)]++] = uint32_t(s);
+        }
+    }
+
+    // Kolizje zakresu cząstek (już po kroku dt) z kulami; tylko odczyt siatki, więc bezpieczne z wielu wątków
+    // Przy kilku kulach szybsze jest sprawdzenie wszystkich kernelem wektorowym - wynik jest ten sam.
+    void collide(float* x, float* y, float* z, float* vx, float* vy, float* vz, size_t n, float dt) const {
+        if (spheres.size() <= bruteForceLimit) {
+            const SimdKernels::Table& k = SimdKernels::active();
+            for (const auto& s : spheres) {
+                k.collideSphere(x, y, z, vx, vy, vz, n, s.center.x, s.center.y, s.center.z, s.radius, dt);
+            }
+            return;
+        }
+        if (dims[0] == 0) return;
+        thread_local std::vector<uint32_t> candidates;     //Kule z kilku komórek - rośnie tylko raz na wątek
+        for (size_t i = 0; i < n; ++i) {
+            const float dx = vx[i] * dt, dy = vy[i] * dt, dz = vz[i] * dt;
+            const float reach = std::fabs(dx) + std::fabs(dy) + std::fabs(dz);
+            float lo[3] = { std::min(x[i], x[i] - dx) - reach, std::min(y[i], y[i] - dy) - reach, std::min(z[i], z[i] - dz) - reach };
+            float hi[3] = { std::max(x[i], x[i] - dx) + reach, std::max(y[i], y[i] - dy) + reach, std::max(z[i], z[i] - dz) + reach };
+            const float origin[3] = { gridMin.x, gridMin.y, gridMin.z };
+            int lo3[3], hi3[3];
+            bool outside = false;
+            for (int a = 0; a < 3; ++a) {
+                float fl = (lo[a] - origin[a]) * invCellSize, fh = (hi[a] - origin[a]) * invCellSize;
+                if (!(fh >= 0 && fl < dims[a])) outside = true;        //Poza siatką nie ma kul
+                lo3[a] = std::max(0, int(std::floor(std::max(fl, -1.0f))));
+                hi3[a] = std::min(dims[a] - 1, int(std::floor(std::min(fh, float(dims[a])))));
+            }
+            if (outside) continue;
+
+            if (lo3[0] == hi3[0] && lo3[1] == hi3[1] && lo3[2] == hi3[2]) {    //Zwykle - cały ruch w jednej komórce
+                size_t c = cellIndex(lo3[0], lo3[1], lo3[2]);
+                for (uint32_t k = cellStart[c]; k < cellStart[c + 1]; ++k) {
+                    const SphereCollider& s = spheres[cellSpheres[k]];
+                    SimdKernels::sweepSphere(x[i], y[i], z[i], vx[i], vy[i], vz[i], s.center.x, s.center.y, s.center.z, s.radius, dt);
+                }
+                continue;
+            }
+            candidates.clear();
+            for (int cz = lo3[2]; cz <= hi3[2]; ++cz)
+                for (int cy = lo3[1]; cy <= hi3[1]; ++cy)
+                    for (int cx = lo3[0]; cx <= hi3[0]; ++cx) {
+                        size_t c = cellIndex(cx, cy, cz);
+                        candidates.insert(candidates.end(), cellSpheres.begin() + cellStart[c], cellSpheres.begin() + cellStart[c + 1]);
+                    }
+            std::sort(candidates.begin(), candidates.end());
+            candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+            for (uint32_t index : candidates) {
+                const SphereCollider& s = spheres[index];
+                SimdKernels::sweepSphere(x[i], y[i], z[i], vx[i], vy[i], vz[i], s.center.x, s.center.y, s.center.z, s.radius, dt);
+            }
+        }
+    }
+
+    size_t cellCount() const { return size_t(dims[0]) * dims[1] * dims[2]; }
+
+private:
+    static const size_t maxCells = size_t(1) << 21;
+    static const size_t bruteForceLimit = 16;   //Do tylu kul siatka nie jest używana
+
+    std::vector<SphereCollider> spheres;
+    bool dirty;
+
+    float cellSize, invCellSize;
+    ofVec3f gridMin;
+    int dims[3];
+    std::vector<uint32_t> cellStart;        //Początek listy kul komórki c w cellSpheres (cells + 1 elementów)
+    std::vector<uint32_t> cellSpheres;      //Indeksy kul, pogrupowane komórkami
+    std::vector<uint32_t> cellFill;         //Pomocnicze przy budowie
+
+    size_t cellIndex(int x, int y, int z) const {
+        return (size_t(z) * dims[1] + y) * dims[0] + x;
+    }
+
+    int clampCell(float v, float origin, int dim) const {
+        return std::min(dim - 1, std::max(0, int(std::floor((v - origin) * invCellSize))));
+    }
+
+    void cellRange(const SphereCollider& s, int lo[3], int hi[3]) const {
+        lo[0] = clampCell(s.center.x - s.radius, gridMin.x, dims[0]); hi[0] = clampCell(s.center.x + s.radius, gridMin.x, dims[0]);
+        lo[1] = clampCell(s.center.y - s.radius, gridMin.y, dims[1]); hi[1] = clampCell(s.center.y + s.radius, gridMin.y, dims[1]);
+        lo[2] = clampCell(s.center.z - s.radius, gridMin.z, dims[2]); hi[2] = clampCell(s.center.z + s.radius, gridMin.z, dims[2]);
+    }
+};